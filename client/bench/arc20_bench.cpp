@@ -0,0 +1,77 @@
+// Per-call cost of ARC20 actions, measured on the host: contract/arc20.cpp
+// is compiled against the PlatON stand-in in client/bench/host and every
+// call is metered (state reads and writes with their bytes, debug output,
+// events) and timed natively. On chain these host calls are charged on top
+// of the metered wasm, whose instruction count the native time stands in
+// for; gas itself needs the CDT and a node.
+//
+// Trace levels, see PRIVACY_TRACE_LEVEL in contract/common.hpp:
+//
+//   g++ -std=c++17 -O2 -I client/bench/host -I contract client/bench/arc20_bench.cpp -o arc20_bench
+//   g++ -std=c++17 -O2 -DPRIVACY_TRACE_LEVEL=2 -I client/bench/host -I contract client/bench/arc20_bench.cpp -o arc20_bench_trace
+//   ./arc20_bench [calls] && ./arc20_bench_trace [calls]
+//
+// Every call is a fresh contract object, as for a transaction. BatchTransfer
+// rows pay `calls` recipients in batches of the given size and are reported
+// per recipient, next to one Transfer call per recipient.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "arc20.cpp"
+
+namespace {
+
+platon::Address Account(uint64_t i) { return platon::Address(0x10000 + i); }
+
+template <typename F>
+double Seconds(F f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+void PrintRow(const char *name, uint64_t calls, double seconds, const platon::host::Meter &m) {
+  double n = double(calls);
+  printf("%-14s %9.0f %8.2f %8.1f %8.2f %8.1f %8.2f %8.1f %8.2f %8.1f\n", name, 1e9 * seconds / n,
+         m.reads / n, m.read_bytes / n, m.writes / n, m.write_bytes / n, m.debug_calls / n,
+         m.debug_bytes / n, m.events / n, m.event_bytes / n);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  uint64_t calls = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+  const uint64_t kRecipients = 1000;
+
+  platon::host::caller() = Account(0);
+  ARC20().init("Token", "TKN", platon::u128(1) << 100, 18);
+
+  printf("trace level %d, %llu recipients, per recipient:\n", PRIVACY_TRACE_LEVEL, (unsigned long long)calls);
+  printf("%-14s %9s %8s %8s %8s %8s %8s %8s %8s %8s\n", "action", "ns", "reads", "bytes", "writes",
+         "bytes", "debug", "bytes", "events", "bytes");
+
+  platon::host::meter() = platon::host::Meter();
+  double seconds = Seconds([&] {
+    for (uint64_t i = 0; i < calls; i++) ARC20().Transfer(Account(1 + i % kRecipients), 1);
+  });
+  PrintRow("Transfer", calls, seconds, platon::host::meter());
+
+  for (uint64_t size : {1, 10, 100, 1000}) {
+    char name[32];
+    snprintf(name, sizeof(name), "Batch %llu", (unsigned long long)size);
+    uint64_t batches = calls / size, next = 0;
+    platon::host::meter() = platon::host::Meter();
+    seconds = Seconds([&] {
+      for (uint64_t b = 0; b < batches; b++) {
+        std::vector<std::pair<platon::Address, platon::u128>> transfers;
+        for (uint64_t i = 0; i < size; i++) transfers.emplace_back(Account(1 + next++ % kRecipients), 1);
+        ARC20().BatchTransfer(transfers);
+      }
+    });
+    PrintRow(name, batches * size, seconds, platon::host::meter());
+  }
+  return 0;
+}
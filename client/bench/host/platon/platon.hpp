@@ -0,0 +1,255 @@
+#pragma once
+
+// Host stand-in for the part of the PlatON CDT that contract/arc20.cpp and
+// contract/common.hpp use, so benchmarks can run the contract code
+// natively. Not a chain: state is an in-memory map, events are dropped,
+// cross-contract calls and transfers fail and platon_revert throws. Every
+// host call the chain charges for outside the wasm interpreter is counted
+// in host::Meter: state reads and writes with their key and value bytes,
+// debug output (println) and event payloads.
+//
+// Address::toString() returns hex, which is cheaper to format than the
+// bech32 string of the CDT.
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace platon {
+
+using byte = uint8_t;
+using bytes = std::vector<byte>;
+using u128 = unsigned __int128;
+
+template <size_t N>
+class FixedHash {
+ public:
+  static constexpr size_t size = N;
+
+  FixedHash() { data_.fill(0); }
+  explicit FixedHash(uint64_t low) {
+    data_.fill(0);
+    for (size_t i = 0; i < 8 && i < N; i++) data_[N - 1 - i] = byte(low >> (8 * i));
+  }
+
+  byte *data() { return data_.data(); }
+  const byte *data() const { return data_.data(); }
+
+  bool operator==(const FixedHash &o) const { return data_ == o.data_; }
+  bool operator!=(const FixedHash &o) const { return data_ != o.data_; }
+  bool operator<(const FixedHash &o) const { return data_ < o.data_; }
+
+  std::string toString() const {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string s = "0x";
+    for (byte b : data_) {
+      s += kDigits[b >> 4];
+      s += kDigits[b & 15];
+    }
+    return s;
+  }
+
+ private:
+  std::array<byte, N> data_;
+};
+
+using Address = FixedHash<20>;
+using h256 = FixedHash<32>;
+
+struct Name {
+  enum class Raw : uint64_t {};
+};
+
+constexpr uint64_t name_value(const char *s) {
+  uint64_t v = 14695981039346656037ull;  // FNV-1a, only needs to be distinct
+  for (; *s; s++) v = (v ^ uint8_t(*s)) * 1099511628211ull;
+  return v;
+}
+
+constexpr Name::Raw operator""_n(const char *s, size_t) { return Name::Raw(name_value(s)); }
+
+class Contract {};
+
+namespace host {
+
+struct Meter {
+  uint64_t reads = 0, read_bytes = 0;
+  uint64_t writes = 0, write_bytes = 0;
+  uint64_t debug_calls = 0, debug_bytes = 0;
+  uint64_t events = 0, event_bytes = 0;
+};
+
+inline Meter &meter() {
+  static Meter m;
+  return m;
+}
+
+inline std::map<std::string, std::string> &state() {
+  static std::map<std::string, std::string> s;
+  return s;
+}
+
+inline Address &caller() {
+  static Address a;
+  return a;
+}
+
+inline Address &self() {
+  static Address a(0xc0de);
+  return a;
+}
+
+// Payload size of an event argument as the chain would RLP-encode it,
+// ignoring the length prefixes.
+inline size_t EventSize(const Address &) { return Address::size; }
+inline size_t EventSize(u128) { return 16; }
+inline size_t EventSize(const std::string &s) { return s.size(); }
+template <typename A, typename B>
+size_t EventSize(const std::pair<A, B> &p) {
+  return EventSize(p.first) + EventSize(p.second);
+}
+template <typename T>
+size_t EventSize(const std::vector<T> &v) {
+  size_t n = 0;
+  for (const T &x : v) n += EventSize(x);
+  return n;
+}
+
+template <typename... Args>
+void Emit(const Args &...args) {
+  meter().events++;
+  meter().event_bytes += (size_t(0) + ... + EventSize(args));
+}
+
+}  // namespace host
+
+inline Address platon_caller() { return host::caller(); }
+inline Address platon_address() { return host::self(); }
+inline int64_t platon_timestamp() { return 0; }
+inline h256 platon_sha3(const bytes &) { return h256(); }
+inline int32_t platon_ecrecover(const h256 &, const bytes &, Address &) { return -1; }
+inline u128 platon_call_value() { return 0; }
+
+struct Energon {
+  explicit Energon(u128 value) : value(value) {}
+  u128 value;
+};
+
+inline bool platon_transfer(const Address &, const Energon &) { return false; }
+
+template <typename R, typename... Args>
+std::pair<R, bool> platon_call_with_return_value(const Address &, u128, uint64_t, const std::string &,
+                                                 const Args &...) {
+  return {R(), false};
+}
+
+namespace internal {
+
+inline void Append(std::string &out, const char *s) { out += s; }
+inline void Append(std::string &out, const std::string &s) { out += s; }
+inline void Append(std::string &out, u128 v) {
+  char buf[40];
+  size_t n = sizeof(buf);
+  do {
+    buf[--n] = char('0' + unsigned(v % 10));
+    v /= 10;
+  } while (v != 0);
+  out.append(buf + n, sizeof(buf) - n);
+}
+template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+void Append(std::string &out, T v) {
+  out += std::to_string(v);
+}
+
+}  // namespace internal
+
+template <typename... Args>
+void print(std::string &out, Args &&...args) {
+  ((internal::Append(out, args), out += ' '), ...);
+}
+
+template <typename... Args>
+void println(Args &&...args) {
+  std::string line;
+  print(line, std::forward<Args>(args)...);
+  line += '\n';
+  host::meter().debug_calls++;
+  host::meter().debug_bytes += line.size();
+}
+
+namespace crypto {
+namespace bn256 {
+struct G1 {};
+struct G2 {};
+}  // namespace bn256
+}  // namespace crypto
+
+}  // namespace platon
+
+namespace std {
+
+// only what common.hpp needs to compile
+class uint256_t {
+ public:
+  uint256_t(uint64_t v = 0) : low_(v) {}
+  void ToBigEndian(platon::bytes &out) const {
+    out.clear();
+    for (int i = 7; i >= 0; i--) {
+      if (!out.empty() || (low_ >> (8 * i)) != 0) out.push_back(uint8_t(low_ >> (8 * i)));
+    }
+  }
+
+ private:
+  uint64_t low_;
+};
+
+}  // namespace std
+
+inline int32_t platon_get_state(const uint8_t *key, size_t key_len, uint8_t *value, size_t value_len) {
+  auto &meter = platon::host::meter();
+  meter.reads++;
+  meter.read_bytes += key_len;
+  auto it = platon::host::state().find(std::string((const char *)key, key_len));
+  if (it == platon::host::state().end()) return -1;
+  size_t n = std::min(value_len, it->second.size());
+  memcpy(value, it->second.data(), n);
+  meter.read_bytes += n;
+  return int32_t(n);
+}
+
+inline size_t platon_get_state_length(const uint8_t *key, size_t key_len) {
+  auto &meter = platon::host::meter();
+  meter.reads++;
+  meter.read_bytes += key_len;
+  auto it = platon::host::state().find(std::string((const char *)key, key_len));
+  return it == platon::host::state().end() ? 0 : it->second.size();
+}
+
+inline void platon_set_state(const uint8_t *key, size_t key_len, const uint8_t *value, size_t value_len) {
+  auto &meter = platon::host::meter();
+  meter.writes++;
+  meter.write_bytes += key_len + value_len;
+  platon::host::state()[std::string((const char *)key, key_len)] = std::string((const char *)value, value_len);
+}
+
+inline uint64_t platon_gas() { return 0; }
+
+[[noreturn]] inline void platon_revert() { throw std::runtime_error("revert"); }
+
+#define CONTRACT class
+#define ACTION
+#define CONST
+#define PLATON_SERIALIZE(...)
+#define PLATON_EVENT0(...)
+#define PLATON_EVENT1(...)
+#define PLATON_EVENT2(...)
+#define PLATON_EMIT_EVENT0(name, ...) ::platon::host::Emit(__VA_ARGS__)
+#define PLATON_EMIT_EVENT1(name, ...) ::platon::host::Emit(__VA_ARGS__)
+#define PLATON_EMIT_EVENT2(name, ...) ::platon::host::Emit(__VA_ARGS__)
+#define PLATON_DISPATCH(...)
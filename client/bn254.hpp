@@ -0,0 +1,4 @@
+#pragma once
+
+// Shared with the contracts, see contract/bn254.hpp.
+#include "../contract/bn254.hpp"
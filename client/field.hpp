@@ -0,0 +1,4 @@
+#pragma once
+
+// Shared with the contracts, see contract/field.hpp.
+#include "../contract/field.hpp"
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "field.hpp"
+#include "merkle_store.hpp"
+#include "mimc.hpp"
+
+namespace privacy {
+
+// Client copy of PrivacyArc20::getCheckpoint.
+struct Checkpoint {
+  uint64_t count = 0;
+  Fr root;
+  std::array<Fr, MerkleStore::kDepth> frontier;
+};
+
+// Right edge of the commitment tree: enough to keep the root in step with
+// the contract from a checkpoint on, without any of the earlier leaves.
+// Appending costs kDepth hashes.
+class Frontier {
+ public:
+  static constexpr uint32_t kDepth = MerkleStore::kDepth;
+
+  Frontier() = default;
+
+  // Bootstraps from a getCheckpoint result. The root is recomputed from
+  // the frontier, so a checkpoint whose parts were read from different
+  // states is rejected.
+  explicit Frontier(const Checkpoint &checkpoint)
+      : count_(checkpoint.count), frontier_(checkpoint.frontier) {
+    if (count_ > MerkleStore::kWidth) throw std::invalid_argument("checkpoint: count out of range");
+    root_ = ComputeRoot();
+    if (root_ != checkpoint.root) throw std::invalid_argument("checkpoint: root does not match frontier");
+  }
+
+  uint64_t Count() const { return count_; }
+  const Fr &Root() const { return root_; }
+
+  // Follows a `create` event emitted after the checkpoint; events at or
+  // before it are ignored.
+  void ApplyCreate(const Fr &commitment, uint64_t coin_index) {
+    uint64_t leaf = MerkleStore::LeafFromCoinIndex(coin_index);
+    if (leaf < count_) return;
+    if (leaf > count_) {
+      throw std::runtime_error("frontier: missing create events before leaf " + std::to_string(leaf));
+    }
+    Append(commitment);
+  }
+
+  void Append(const Fr &commitment) {
+    if (count_ == MerkleStore::kWidth) throw std::length_error("frontier: tree is full");
+    Fr node = commitment;
+    for (uint32_t level = 0; level < kDepth; level++) {
+      if (((count_ >> level) & 1) == 0) {
+        frontier_[level] = node;
+        node = Mimc::Hash2(node, Fr());
+      } else {
+        node = Mimc::Hash2(frontier_[level], node);
+      }
+    }
+    root_ = node;
+    count_++;
+  }
+
+  Checkpoint ToCheckpoint() const {
+    Checkpoint checkpoint;
+    checkpoint.count = count_;
+    checkpoint.root = root_;
+    for (uint32_t level = 0; level < kDepth; level++) {
+      if ((count_ >> level) & 1) checkpoint.frontier[level] = frontier_[level];
+    }
+    return checkpoint;
+  }
+
+  // Left sibling of the next leaf's ancestor at `level`; only meaningful
+  // when that ancestor is a right child.
+  const Fr &LeftSibling(uint32_t level) const { return frontier_[level]; }
+
+ private:
+  // Empty subtrees are zero, not H(0, 0): the contract never writes nodes
+  // no leaf has reached.
+  Fr ComputeRoot() const {
+    Fr node;
+    bool empty = true;
+    for (uint32_t level = 0; level < kDepth; level++) {
+      if ((count_ >> level) & 1) {
+        node = Mimc::Hash2(frontier_[level], node);
+        empty = false;
+      } else if (!empty) {
+        node = Mimc::Hash2(node, Fr());
+      }
+    }
+    return node;
+  }
+
+  uint64_t count_ = 0;
+  Fr root_;
+  std::array<Fr, kDepth> frontier_{};
+};
+
+}  // namespace privacy
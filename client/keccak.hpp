@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace privacy {
+
+// Keccak-256 with the original (pre-SHA3) padding, i.e. the hash the chain
+// and the MiMC constant schedule use.
+class Keccak256 {
+ public:
+  using Digest = std::array<uint8_t, 32>;
+
+  Keccak256() { Reset(); }
+
+  void Reset() {
+    memset(state_, 0, sizeof(state_));
+    offset_ = 0;
+  }
+
+  Keccak256 &Update(const void *data, size_t len) {
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    while (len > 0) {
+      size_t n = kRate - offset_;
+      if (n > len) n = len;
+      for (size_t i = 0; i < n; i++) {
+        size_t pos = offset_ + i;
+        state_[pos / 8] ^= uint64_t(p[i]) << (8 * (pos % 8));
+      }
+      offset_ += n;
+      p += n;
+      len -= n;
+      if (offset_ == kRate) {
+        Permute(state_);
+        offset_ = 0;
+      }
+    }
+    return *this;
+  }
+
+  Digest Final() {
+    state_[offset_ / 8] ^= uint64_t(0x01) << (8 * (offset_ % 8));
+    state_[(kRate - 1) / 8] ^= uint64_t(0x80) << (8 * ((kRate - 1) % 8));
+    Permute(state_);
+    Digest out;
+    for (size_t i = 0; i < 32; i++) out[i] = uint8_t(state_[i / 8] >> (8 * (i % 8)));
+    Reset();
+    return out;
+  }
+
+  static Digest Hash(const void *data, size_t len) {
+    Keccak256 k;
+    return k.Update(data, len).Final();
+  }
+
+ private:
+  static constexpr size_t kRate = 136;
+
+  static uint64_t Rotl(uint64_t x, unsigned n) {
+    return n == 0 ? x : (x << n) | (x >> (64 - n));
+  }
+
+  static void Permute(uint64_t *a) {
+    static const uint64_t kRoundConstants[24] = {
+        0x0000000000000001ull, 0x0000000000008082ull, 0x800000000000808aull,
+        0x8000000080008000ull, 0x000000000000808bull, 0x0000000080000001ull,
+        0x8000000080008081ull, 0x8000000000008009ull, 0x000000000000008aull,
+        0x0000000000000088ull, 0x0000000080008009ull, 0x000000008000000aull,
+        0x000000008000808bull, 0x800000000000008bull, 0x8000000000008089ull,
+        0x8000000000008003ull, 0x8000000000008002ull, 0x8000000000000080ull,
+        0x000000000000800aull, 0x800000008000000aull, 0x8000000080008081ull,
+        0x8000000000008080ull, 0x0000000080000001ull, 0x8000000080008008ull};
+    static const unsigned kRotations[25] = {0,  1,  62, 28, 27, 36, 44, 6,  55,
+                                            20, 3,  10, 43, 25, 39, 41, 45, 15,
+                                            21, 8,  18, 2,  61, 56, 14};
+    for (int round = 0; round < 24; round++) {
+      uint64_t c[5], b[25];
+      for (int x = 0; x < 5; x++) c[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+      for (int x = 0; x < 5; x++) {
+        uint64_t d = c[(x + 4) % 5] ^ Rotl(c[(x + 1) % 5], 1);
+        for (int y = 0; y < 25; y += 5) a[y + x] ^= d;
+      }
+      for (int x = 0; x < 5; x++) {
+        for (int y = 0; y < 5; y++) {
+          b[y + 5 * ((2 * x + 3 * y) % 5)] = Rotl(a[x + 5 * y], kRotations[x + 5 * y]);
+        }
+      }
+      for (int y = 0; y < 25; y += 5) {
+        for (int x = 0; x < 5; x++) a[y + x] = b[y + x] ^ (~b[y + (x + 1) % 5] & b[y + (x + 2) % 5]);
+      }
+      a[0] ^= kRoundConstants[round];
+    }
+  }
+
+  uint64_t state_[25];
+  size_t offset_;
+};
+
+}  // namespace privacy
@@ -0,0 +1,219 @@
+#include "merkle_store.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#include "mimc_batch.hpp"
+
+namespace privacy {
+
+namespace {
+
+constexpr char kMagic[8] = {'z', 'k', 'm', 'e', 'r', 'k', 'l', 'e'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 4096;
+constexpr uint64_t kMinCapacity = 1024;
+
+[[noreturn]] void ThrowErrno(const std::string &what) {
+  throw std::runtime_error("merkle store: " + what + ": " + strerror(errno));
+}
+
+}  // namespace
+
+struct MerkleStore::Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t depth;
+  uint64_t capacity;
+  uint64_t count;
+};
+
+MerkleStore::MerkleStore(const std::string &file) {
+  fd_ = ::open(file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) ThrowErrno("open " + file);
+
+  struct stat st;
+  if (::fstat(fd_, &st) != 0) ThrowErrno("stat " + file);
+
+  if (st.st_size == 0) {
+    Map(kMinCapacity);
+    memcpy(header_->magic, kMagic, sizeof(kMagic));
+    header_->version = kVersion;
+    header_->depth = kDepth;
+    header_->capacity = kMinCapacity;
+    header_->count = 0;
+    return;
+  }
+
+  if (size_t(st.st_size) < kHeaderSize) throw std::runtime_error("merkle store: truncated " + file);
+  Header h;
+  if (::pread(fd_, &h, sizeof(h), 0) != ssize_t(sizeof(h))) ThrowErrno("read " + file);
+  if (memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion || h.depth != kDepth) {
+    throw std::runtime_error("merkle store: " + file + " is not a tree file");
+  }
+  Map(h.capacity);
+}
+
+MerkleStore::~MerkleStore() {
+  if (header_ != nullptr) {
+    ::msync(header_, mapped_, MS_SYNC);
+    ::munmap(header_, mapped_);
+  }
+  if (fd_ >= 0) ::close(fd_);
+}
+
+uint64_t MerkleStore::LeafFromCoinIndex(uint64_t coin_index) {
+  if (coin_index < kWidth - 1 || coin_index >= 2 * kWidth - 1) {
+    throw std::out_of_range("merkle store: coin index is not a leaf");
+  }
+  return coin_index - (kWidth - 1);
+}
+
+uint64_t MerkleStore::LevelSize(uint64_t capacity, uint32_t level) {
+  uint64_t size = capacity >> level;
+  return size == 0 ? 1 : size;
+}
+
+MerkleStore::Layout MerkleStore::MakeLayout(uint64_t capacity) {
+  Layout layout;
+  layout[0] = 0;
+  for (uint32_t level = 0; level <= kDepth; level++) {
+    layout[level + 1] = layout[level] + LevelSize(capacity, level);
+  }
+  return layout;
+}
+
+void MerkleStore::Map(uint64_t capacity) {
+  Layout layout = MakeLayout(capacity);
+  size_t size = kHeaderSize + layout[kDepth + 1] * sizeof(Node);
+  if (::ftruncate(fd_, off_t(size)) != 0) ThrowErrno("resize");
+
+  if (header_ != nullptr) ::munmap(header_, mapped_);
+  void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (p == MAP_FAILED) ThrowErrno("mmap");
+
+  header_ = static_cast<Header *>(p);
+  nodes_ = reinterpret_cast<Node *>(static_cast<char *>(p) + kHeaderSize);
+  mapped_ = size;
+  capacity_ = capacity;
+  layout_ = layout;
+}
+
+void MerkleStore::Grow(uint64_t leaves) {
+  if (leaves <= capacity_) return;
+  uint64_t capacity = capacity_;
+  while (capacity < leaves) capacity <<= 1;
+
+  Layout from = layout_;
+  uint64_t old_capacity = capacity_;
+  ::msync(header_, mapped_, MS_SYNC);
+  Map(capacity);
+
+  // Every level only moves towards the end of the file, so shifting from the
+  // root down never overwrites a level that has not been moved yet.
+  for (int level = kDepth; level >= 0; level--) {
+    uint64_t old_size = LevelSize(old_capacity, level);
+    uint64_t new_size = LevelSize(capacity, level);
+    Node *dst = nodes_ + layout_[level];
+    memmove(dst, nodes_ + from[level], old_size * sizeof(Node));
+    memset(dst + old_size, 0, (new_size - old_size) * sizeof(Node));
+  }
+  header_->capacity = capacity;
+  ::msync(header_, mapped_, MS_SYNC);
+}
+
+Fr MerkleStore::NodeAt(uint32_t level, uint64_t index) const {
+  if (index >= LevelSize(capacity_, level)) return Fr();
+  return Fr::FromCanonical(nodes_[layout_[level] + index]);
+}
+
+void MerkleStore::SetNode(uint32_t level, uint64_t index, const Fr &value) {
+  nodes_[layout_[level] + index] = value.ToCanonical();
+}
+
+uint64_t MerkleStore::Count() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return header_->count;
+}
+
+Fr MerkleStore::Root() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return NodeAt(kDepth, 0);
+}
+
+Fr MerkleStore::Leaf(uint64_t leaf) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  if (leaf >= header_->count) throw std::out_of_range("merkle store: leaf not yet created");
+  return NodeAt(0, leaf);
+}
+
+void MerkleStore::ApplyCreate(const Fr &commitment, uint64_t coin_index) {
+  uint64_t leaf = LeafFromCoinIndex(coin_index);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  uint64_t count = header_->count;
+  if (leaf < count) {
+    if (NodeAt(0, leaf) != commitment) {
+      throw std::runtime_error("merkle store: conflicting commitment at leaf " + std::to_string(leaf));
+    }
+    return;
+  }
+  if (leaf > count) {
+    throw std::runtime_error("merkle store: missing create events before leaf " + std::to_string(leaf));
+  }
+  AppendLocked({commitment});
+}
+
+void MerkleStore::Append(const std::vector<Fr> &commitments) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  AppendLocked(commitments);
+}
+
+void MerkleStore::AppendLocked(const std::vector<Fr> &commitments) {
+  if (commitments.empty()) return;
+  uint64_t first = header_->count;
+  uint64_t end = first + commitments.size();
+  if (end > kWidth) throw std::length_error("merkle store: tree is full");
+  Grow(end);
+
+  for (size_t i = 0; i < commitments.size(); i++) SetNode(0, first + i, commitments[i]);
+
+  // Same node order as updatePathToRoot: left child first, missing right
+  // children read as zero. Each level's touched parents are hashed as one
+  // batch.
+  std::vector<Fr> children, parents;
+  uint64_t lo = first, hi = end - 1;
+  for (uint32_t level = 0; level < kDepth; level++) {
+    lo >>= 1;
+    hi >>= 1;
+    children.resize(2 * (hi - lo + 1));
+    parents.resize(hi - lo + 1);
+    for (size_t i = 0; i < children.size(); i++) children[i] = NodeAt(level, 2 * lo + i);
+    MimcHashLevel(children.data(), children.size(), parents.data());
+    for (size_t i = 0; i < parents.size(); i++) SetNode(level + 1, lo + i, parents[i]);
+  }
+  header_->count = end;
+}
+
+MerkleStore::Path MerkleStore::GetPath(uint64_t leaf) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  if (leaf >= header_->count) throw std::out_of_range("merkle store: leaf not yet created");
+  Path path;
+  for (uint32_t level = 0; level < kDepth; level++) {
+    path[level] = NodeAt(level, (leaf >> level) ^ 1);
+  }
+  return path;
+}
+
+void MerkleStore::Sync() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  if (::msync(header_, mapped_, MS_SYNC) != 0) ThrowErrno("msync");
+}
+
+}  // namespace privacy
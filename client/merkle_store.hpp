@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "field.hpp"
+
+namespace privacy {
+
+// Persistent mirror of PrivacyArc20's commitment tree.
+//
+// Nodes are kept in a single mmap-backed file, level-major: all leaves
+// first, then their parents, up to the root. Every level is sized for the
+// current capacity (a power of two leaves) and the file is re-laid out in
+// place when the capacity doubles. Unset nodes read as zero, exactly like
+// the contract's `merkleNodes` map, so roots match updatePathToRoot.
+//
+// Readers (GetPath, Root) take a shared lock and touch one node per level;
+// Append takes the exclusive lock.
+class MerkleStore {
+ public:
+  static constexpr uint32_t kDepth = 32;                // hashes from leaf to root
+  static constexpr uint64_t kWidth = 1ull << kDepth;   // merkleWidth in the contract
+
+  using Path = std::array<Fr, kDepth>;
+
+  // Opens `file`, creating an empty tree if it does not exist.
+  explicit MerkleStore(const std::string &file);
+  ~MerkleStore();
+
+  MerkleStore(const MerkleStore &) = delete;
+  MerkleStore &operator=(const MerkleStore &) = delete;
+
+  // The contract emits heap indices in `create` events (leaf n is at
+  // merkleWidth - 1 + n); these convert between the two.
+  static uint64_t LeafFromCoinIndex(uint64_t coin_index);
+  static uint64_t CoinIndexFromLeaf(uint64_t leaf) { return kWidth - 1 + leaf; }
+
+  uint64_t Count() const;
+  Fr Root() const;
+  Fr Leaf(uint64_t leaf) const;
+
+  // Applies one `create` event. Events already applied are ignored when
+  // the stored commitment matches, so a scanner may replay overlapping
+  // block ranges; a gap or a conflicting commitment throws.
+  void ApplyCreate(const Fr &commitment, uint64_t coin_index);
+
+  // Appends leaves in order. Parents are refreshed once per level for the
+  // whole batch, which is what makes the initial sync cheap.
+  void Append(const std::vector<Fr> &commitments);
+
+  // Sibling hashes from the leaf up to the child of the root, the order
+  // the circuits take `path` in. Reads one node per level.
+  Path GetPath(uint64_t leaf) const;
+
+  // Flushes dirty pages to disk.
+  void Sync();
+
+ private:
+  struct Header;
+  using Node = Limbs;  // canonical little-endian limbs
+
+  using Layout = std::array<uint64_t, kDepth + 2>;  // node offset of each level, then the total
+
+  static Layout MakeLayout(uint64_t capacity);
+  static uint64_t LevelSize(uint64_t capacity, uint32_t level);
+  Fr NodeAt(uint32_t level, uint64_t index) const;
+  void SetNode(uint32_t level, uint64_t index, const Fr &value);
+  void Map(uint64_t capacity);
+  void Grow(uint64_t leaves);
+  void AppendLocked(const std::vector<Fr> &commitments);
+
+  mutable std::shared_mutex mutex_;
+  int fd_ = -1;
+  Header *header_ = nullptr;
+  Node *nodes_ = nullptr;
+  size_t mapped_ = 0;
+  uint64_t capacity_ = 0;
+  Layout layout_{};
+};
+
+}  // namespace privacy
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "field.hpp"
+#include "keccak.hpp"
+
+namespace privacy {
+
+// MiMC-7 with 91 rounds as used by the .zok circuits and by the contract's
+// Mimc::Hash. Round constants follow the circomlib/zokrates schedule:
+// c[0] = 0, c[i] = keccak256^(i+1)("mimc") mod r.
+class Mimc {
+ public:
+  static constexpr size_t kRounds = 91;
+
+  static const std::array<Fr, kRounds> &Constants() {
+    static const std::array<Fr, kRounds> constants = MakeConstants();
+    return constants;
+  }
+
+  // mimc7Hash(x_in, k) from the circuits.
+  static Fr Permute(const Fr &x, const Fr &k) {
+    const std::array<Fr, kRounds> &c = Constants();
+    Fr r;
+    for (size_t i = 0; i < kRounds; i++) {
+      Fr t = i == 0 ? k + x : k + r + c[i];
+      Fr t2 = t.Square();
+      Fr t4 = t2.Square();
+      r = t2 * t4 * t;
+    }
+    return r + x;
+  }
+
+  // Miyaguchi-Preneel over the inputs, the mimc2/mimc3 of the circuits.
+  static Fr Hash(const std::vector<Fr> &data, const Fr &key) {
+    Fr r = key;
+    for (const Fr &x : data) r = r + x + Permute(x, r);
+    return r;
+  }
+
+  // Parent of two tree nodes, i.e. Mimc::Hash({left, right}, 0).
+  static Fr Hash2(const Fr &left, const Fr &right) {
+    Fr r = left + Permute(left, Fr());
+    return r + right + Permute(right, r);
+  }
+
+ private:
+  static std::array<Fr, kRounds> MakeConstants() {
+    std::array<Fr, kRounds> c;
+    Keccak256::Digest d = Keccak256::Hash("mimc", 4);
+    for (size_t i = 1; i < kRounds; i++) {
+      d = Keccak256::Hash(d.data(), d.size());
+      c[i] = Fr::FromWide(Fr::BytesToLimbs(d.data()));
+    }
+    return c;
+  }
+};
+
+}  // namespace privacy
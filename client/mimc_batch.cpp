@@ -0,0 +1,322 @@
+#include "mimc_batch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <thread>
+
+#include "mimc.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PRIVACY_MIMC_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace privacy {
+
+namespace {
+
+// Below this many parents a level is hashed on the calling thread.
+constexpr size_t kParallelThreshold = 256;
+
+void HashLevelScalar(const Fr *children, size_t count, Fr *parents, size_t first, size_t last);
+
+#ifdef PRIVACY_MIMC_AVX2
+
+// Radix 2^29: nine limbs hold 261 bits and a 29x29-bit product is 58 bits,
+// so a column of the schoolbook product plus reduction (at most 18 such
+// terms) stays below 2^64 and needs no carry handling until the end.
+// Montgomery form is x * 2^261 mod r. Values are kept lazily reduced below
+// 2^259 and only brought into [0, r) when leaving the kernel.
+constexpr int kLimbs = 9;
+constexpr int kBits = 29;
+constexpr uint64_t kMask = (1ull << kBits) - 1;
+
+using Radix29 = std::array<uint64_t, kLimbs>;
+
+Radix29 ToRadix29(const Limbs &c) {
+  Radix29 r{};
+  for (int i = 0; i < kLimbs; i++) {
+    int bit = i * kBits;
+    uint64_t v = c[bit / 64] >> (bit % 64);
+    if (bit % 64 > 64 - kBits && bit / 64 + 1 < 4) v |= c[bit / 64 + 1] << (64 - bit % 64);
+    r[i] = v & kMask;
+  }
+  return r;
+}
+
+Limbs FromRadix29(const Radix29 &r) {
+  Limbs c{};
+  for (int i = 0; i < kLimbs; i++) {
+    int bit = i * kBits;
+    c[bit / 64] |= r[i] << (bit % 64);
+    if (bit % 64 > 64 - kBits && bit / 64 + 1 < 4) c[bit / 64 + 1] |= r[i] >> (64 - bit % 64);
+  }
+  return c;
+}
+
+struct Avx2Constants {
+  Radix29 modulus;
+  uint64_t inv;          // -r^-1 mod 2^29
+  Fr r261;               // 2^261 mod r, scales into the radix 2^29 Montgomery form
+  std::array<Radix29, Mimc::kRounds> rounds;  // c[i] * 2^261 mod r
+};
+
+const Avx2Constants &Constants29() {
+  static const Avx2Constants constants = [] {
+    Avx2Constants k;
+    k.modulus = ToRadix29(Fr::kModulus);
+    uint64_t inv = 1;  // Newton iteration for r^-1 mod 2^29
+    for (int i = 0; i < 5; i++) inv = inv * (2 - Fr::kModulus[0] * inv);
+    k.inv = (0 - inv) & kMask;
+    k.r261 = Fr::FromUint64(2).Pow(Limbs{261, 0, 0, 0});
+    for (size_t i = 0; i < Mimc::kRounds; i++) {
+      k.rounds[i] = ToRadix29((Mimc::Constants()[i] * k.r261).ToCanonical());
+    }
+    return k;
+  }();
+  return constants;
+}
+
+// four field elements, limb i of lane j in 64-bit slot j of v[i]
+struct Lanes {
+  __m256i v[kLimbs];
+};
+
+__attribute__((target("avx2"))) inline void Normalize(__m256i *t) {
+  const __m256i mask = _mm256_set1_epi64x(kMask);
+  for (int i = 0; i < kLimbs - 1; i++) {
+    t[i + 1] = _mm256_add_epi64(t[i + 1], _mm256_srli_epi64(t[i], kBits));
+    t[i] = _mm256_and_si256(t[i], mask);
+  }
+}
+
+__attribute__((target("avx2"))) inline Lanes Add(const Lanes &a, const Lanes &b) {
+  Lanes r;
+  for (int i = 0; i < kLimbs; i++) r.v[i] = _mm256_add_epi64(a.v[i], b.v[i]);
+  Normalize(r.v);
+  return r;
+}
+
+__attribute__((target("avx2"))) inline Lanes Add3(const Lanes &a, const Lanes &b, const __m256i *c) {
+  Lanes r;
+  for (int i = 0; i < kLimbs; i++) r.v[i] = _mm256_add_epi64(_mm256_add_epi64(a.v[i], b.v[i]), c[i]);
+  Normalize(r.v);
+  return r;
+}
+
+// a * b / 2^261 mod r, operand scanning with one reduction step per limb
+__attribute__((target("avx2"))) inline Lanes Mul(const Lanes &a, const Lanes &b, const __m256i *p,
+                                                 __m256i inv) {
+  const __m256i mask = _mm256_set1_epi64x(kMask);
+  __m256i t[kLimbs];
+  for (int j = 0; j < kLimbs; j++) t[j] = _mm256_setzero_si256();
+  for (int i = 0; i < kLimbs; i++) {
+    for (int j = 0; j < kLimbs; j++) t[j] = _mm256_add_epi64(t[j], _mm256_mul_epu32(a.v[i], b.v[j]));
+    __m256i m = _mm256_and_si256(_mm256_mul_epu32(t[0], inv), mask);
+    for (int j = 0; j < kLimbs; j++) t[j] = _mm256_add_epi64(t[j], _mm256_mul_epu32(m, p[j]));
+    __m256i carry = _mm256_srli_epi64(t[0], kBits);
+    for (int j = 0; j < kLimbs - 1; j++) t[j] = t[j + 1];
+    t[0] = _mm256_add_epi64(t[0], carry);
+    t[kLimbs - 1] = _mm256_setzero_si256();
+  }
+  Normalize(t);
+  Lanes r;
+  for (int j = 0; j < kLimbs; j++) r.v[j] = t[j];
+  return r;
+}
+
+// a * a / 2^261 mod r: the square with each cross product computed once
+// and doubled, then a separate reduction pass
+__attribute__((target("avx2"))) inline Lanes Square(const Lanes &a, const __m256i *p, __m256i inv) {
+  const __m256i mask = _mm256_set1_epi64x(kMask);
+  __m256i t[2 * kLimbs];
+  for (int j = 0; j < 2 * kLimbs; j++) t[j] = _mm256_setzero_si256();
+  for (int i = 0; i < kLimbs; i++) {
+    __m256i twice = _mm256_add_epi64(a.v[i], a.v[i]);
+    t[2 * i] = _mm256_add_epi64(t[2 * i], _mm256_mul_epu32(a.v[i], a.v[i]));
+    for (int j = i + 1; j < kLimbs; j++) t[i + j] = _mm256_add_epi64(t[i + j], _mm256_mul_epu32(twice, a.v[j]));
+  }
+  for (int i = 0; i < kLimbs; i++) {
+    __m256i m = _mm256_and_si256(_mm256_mul_epu32(t[i], inv), mask);
+    for (int j = 0; j < kLimbs; j++) t[i + j] = _mm256_add_epi64(t[i + j], _mm256_mul_epu32(m, p[j]));
+    t[i + 1] = _mm256_add_epi64(t[i + 1], _mm256_srli_epi64(t[i], kBits));
+  }
+  Normalize(t + kLimbs);
+  Lanes r;
+  for (int j = 0; j < kLimbs; j++) r.v[j] = t[kLimbs + j];
+  return r;
+}
+
+struct Kernel {
+  __m256i p[kLimbs];
+  __m256i inv;
+  __m256i rounds[Mimc::kRounds][kLimbs];
+};
+
+__attribute__((target("avx2"))) void InitKernel(Kernel *k) {
+  const Avx2Constants &c = Constants29();
+  for (int j = 0; j < kLimbs; j++) k->p[j] = _mm256_set1_epi64x(c.modulus[j]);
+  k->inv = _mm256_set1_epi64x(c.inv);
+  for (size_t i = 0; i < Mimc::kRounds; i++) {
+    for (int j = 0; j < kLimbs; j++) k->rounds[i][j] = _mm256_set1_epi64x(c.rounds[i][j]);
+  }
+}
+
+// mimc7Hash(x, key) on four lanes
+__attribute__((target("avx2"))) inline Lanes Permute(const Kernel &k, const Lanes &x, const Lanes &key) {
+  Lanes r;
+  for (size_t i = 0; i < Mimc::kRounds; i++) {
+    Lanes t = i == 0 ? Add(key, x) : Add3(key, r, k.rounds[i]);
+    Lanes t2 = Square(t, k.p, k.inv);
+    Lanes t4 = Square(t2, k.p, k.inv);
+    r = Mul(Mul(t2, t4, k.p, k.inv), t, k.p, k.inv);
+  }
+  return Add(r, x);
+}
+
+__attribute__((target("avx2"))) void Load(const Fr *const *in, Lanes *out) {
+  const Fr &r261 = Constants29().r261;
+  alignas(32) uint64_t slots[kLimbs][4];
+  for (int lane = 0; lane < 4; lane++) {
+    Radix29 x = ToRadix29((*in[lane] * r261).ToCanonical());
+    for (int j = 0; j < kLimbs; j++) slots[j][lane] = x[j];
+  }
+  for (int j = 0; j < kLimbs; j++) {
+    out->v[j] = _mm256_load_si256(reinterpret_cast<const __m256i *>(slots[j]));
+  }
+}
+
+__attribute__((target("avx2"))) void Store(const Kernel &k, const Lanes &in, Fr *const *out) {
+  // multiplying by 1 leaves Montgomery form and a value in [0, r]
+  Lanes one;
+  for (int j = 0; j < kLimbs; j++) one.v[j] = _mm256_setzero_si256();
+  one.v[0] = _mm256_set1_epi64x(1);
+  Lanes plain = Mul(in, one, k.p, k.inv);
+  alignas(32) uint64_t slots[kLimbs][4];
+  for (int j = 0; j < kLimbs; j++) _mm256_store_si256(reinterpret_cast<__m256i *>(slots[j]), plain.v[j]);
+  for (int lane = 0; lane < 4; lane++) {
+    Radix29 x;
+    for (int j = 0; j < kLimbs; j++) x[j] = slots[j][lane];
+    *out[lane] = Fr::FromWide(FromRadix29(x));
+  }
+}
+
+// Mimc::Hash2 of four pairs
+__attribute__((target("avx2"))) void Hash2x4(const Kernel &k, const Fr *const *left, const Fr *const *right,
+                                             Fr *const *out) {
+  Lanes l, r, zero;
+  Load(left, &l);
+  Load(right, &r);
+  for (int j = 0; j < kLimbs; j++) zero.v[j] = _mm256_setzero_si256();
+  Lanes key = Add(l, Permute(k, l, zero));
+  Store(k, Add(Add(key, r), Permute(k, r, key)), out);
+}
+
+bool CpuHasAvx2() {
+  static const bool has = __builtin_cpu_supports("avx2");
+  return has;
+}
+
+const Kernel &Avx2Kernel() {
+  static Kernel kernel;
+  static const bool initialized = (InitKernel(&kernel), true);
+  (void)initialized;
+  return kernel;
+}
+
+#else
+
+bool CpuHasAvx2() { return false; }
+
+#endif
+
+const Fr &Zero() {
+  static const Fr zero;
+  return zero;
+}
+
+// parents first..last-1 of a level
+void HashLevelRange(const Fr *children, size_t count, Fr *parents, size_t first, size_t last) {
+#ifdef PRIVACY_MIMC_AVX2
+  if (CpuHasAvx2()) {
+    const Kernel &k = Avx2Kernel();
+    size_t i = first;
+    for (; i + 4 <= last; i += 4) {
+      const Fr *left[4], *right[4];
+      Fr *out[4];
+      for (int lane = 0; lane < 4; lane++) {
+        size_t p = i + lane;
+        left[lane] = &children[2 * p];
+        right[lane] = 2 * p + 1 < count ? &children[2 * p + 1] : &Zero();
+        out[lane] = &parents[p];
+      }
+      Hash2x4(k, left, right, out);
+    }
+    first = i;
+  }
+#endif
+  HashLevelScalar(children, count, parents, first, last);
+}
+
+void HashLevelScalar(const Fr *children, size_t count, Fr *parents, size_t first, size_t last) {
+  for (size_t p = first; p < last; p++) {
+    parents[p] = Mimc::Hash2(children[2 * p], 2 * p + 1 < count ? children[2 * p + 1] : Fr());
+  }
+}
+
+}  // namespace
+
+bool MimcBatchHasAvx2() { return CpuHasAvx2(); }
+
+void MimcHash2Batch(const Fr *left, const Fr *right, Fr *out, size_t n) {
+  size_t i = 0;
+#ifdef PRIVACY_MIMC_AVX2
+  if (CpuHasAvx2()) {
+    const Kernel &k = Avx2Kernel();
+    for (; i + 4 <= n; i += 4) {
+      const Fr *l[4] = {&left[i], &left[i + 1], &left[i + 2], &left[i + 3]};
+      const Fr *r[4] = {&right[i], &right[i + 1], &right[i + 2], &right[i + 3]};
+      Fr *o[4] = {&out[i], &out[i + 1], &out[i + 2], &out[i + 3]};
+      Hash2x4(k, l, r, o);
+    }
+  }
+#endif
+  for (; i < n; i++) out[i] = Mimc::Hash2(left[i], right[i]);
+}
+
+void MimcHashLevel(const Fr *children, size_t count, Fr *parents, unsigned threads) {
+  size_t n = (count + 1) / 2;
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  if (threads == 1 || n < kParallelThreshold) {
+    HashLevelRange(children, count, parents, 0, n);
+    return;
+  }
+
+  // chunks are multiples of four so only the last one has a scalar tail
+  size_t chunk = ((n + threads - 1) / threads + 3) / 4 * 4;
+  std::vector<std::thread> workers;
+  for (size_t first = chunk; first < n; first += chunk) {
+    workers.emplace_back(HashLevelRange, children, count, parents, first, std::min(n, first + chunk));
+  }
+  HashLevelRange(children, count, parents, 0, std::min(n, chunk));
+  for (std::thread &t : workers) t.join();
+}
+
+std::vector<std::vector<Fr>> MimcBuildLevels(std::vector<Fr> leaves, unsigned threads) {
+  constexpr uint32_t kDepth = 32;
+  std::vector<std::vector<Fr>> levels(kDepth + 1);
+  levels[0] = std::move(leaves);
+  if (levels[0].empty()) {  // nothing was ever written, the root reads as zero
+    levels[kDepth].push_back(Fr());
+    return levels;
+  }
+  for (uint32_t level = 0; level < kDepth; level++) {
+    const std::vector<Fr> &children = levels[level];
+    levels[level + 1].resize((children.size() + 1) / 2);
+    MimcHashLevel(children.data(), children.size(), levels[level + 1].data(), threads);
+  }
+  return levels;
+}
+
+}  // namespace privacy
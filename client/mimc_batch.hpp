@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "field.hpp"
+
+namespace privacy {
+
+// Batch MiMC for off-chain tree rebuilds. Results are identical to
+// Mimc::Hash2, i.e. the contract's Mimc::Hash({left, right}, 0).
+//
+// On CPUs with AVX2 four independent pairs are hashed at once, with the
+// field elements in radix 2^29 Montgomery form so that the 32x32-bit
+// vector multiplies accumulate without carries; elsewhere the scalar
+// Mimc::Hash2 is used. Level hashing additionally splits the level across
+// threads.
+
+// out[i] = Mimc::Hash2(left[i], right[i]) for i < n
+void MimcHash2Batch(const Fr *left, const Fr *right, Fr *out, size_t n);
+
+// One tree level: parents[i] = Mimc::Hash2(children[2i], children[2i + 1])
+// for the (count + 1) / 2 parents, a missing last right child is zero.
+// threads = 0 picks the hardware concurrency for large levels.
+void MimcHashLevel(const Fr *children, size_t count, Fr *parents, unsigned threads = 0);
+
+// Every level of the commitment tree over `leaves`, leaves first and the
+// root (levels[32][0]) last, with unset nodes zero as in the contract; the
+// root of an empty tree is zero.
+std::vector<std::vector<Fr>> MimcBuildLevels(std::vector<Fr> leaves, unsigned threads = 0);
+
+// true when MimcHash2Batch runs the AVX2 kernel
+bool MimcBatchHasAvx2();
+
+}  // namespace privacy
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace privacy {
+
+// Plans transfers over a wallet's unspent notes. The transfer circuit
+// spends two notes A, B and creates C for the recipient and D, the change,
+// for the sender, so every proof consumes at most two notes:
+//
+//   payment        the fewest notes covering the amount, largest first, two
+//                  per proof; the recipient gets one note per proof and only
+//                  the last proof has change. All proofs are independent.
+//   consolidation  merges the smallest notes pairwise (C = 0, D = A + B),
+//                  one round at a time, while the wallet is idle.
+//
+// Notes being spent by an unconfirmed job must not be passed in again.
+
+using Amount = unsigned __int128;
+
+struct PlanNote {
+  uint64_t coin_index = 0;
+  Amount amount = 0;
+};
+
+// A second input that does not exist yet: a zero-amount note the wallet has
+// to mint first, because the payment needs an odd number of notes and the
+// wallet has neither a spare note nor a zero note to pad with.
+constexpr uint64_t kPaddingMint = std::numeric_limits<uint64_t>::max();
+
+struct TransferJob {
+  std::array<PlanNote, 2> inputs;
+  Amount pay = 0;     // amountC, to the recipient; 0 when consolidating
+  Amount change = 0;  // amountD, back to the wallet
+};
+
+struct Plan {
+  std::vector<TransferJob> jobs;  // independent of each other
+  size_t padding_mints = 0;       // inputs with coin_index kPaddingMint
+};
+
+namespace detail {
+
+inline bool LargerFirst(const PlanNote &a, const PlanNote &b) {
+  return a.amount != b.amount ? a.amount > b.amount : a.coin_index < b.coin_index;
+}
+
+}  // namespace detail
+
+// Fewest proofs paying `amount`, ceil(m / 2) for the smallest number m of
+// notes that cover it. An odd m is padded with the smallest unused note,
+// which consolidates it for free, else with a zero note.
+inline Plan PlanPayment(std::vector<PlanNote> notes, Amount amount) {
+  if (amount == 0) throw std::invalid_argument("plan payment: zero amount");
+
+  std::vector<PlanNote> zeros;
+  std::vector<PlanNote> spendable;
+  for (const PlanNote &note : notes) (note.amount == 0 ? zeros : spendable).push_back(note);
+  std::sort(spendable.begin(), spendable.end(), detail::LargerFirst);
+
+  std::vector<PlanNote> inputs;
+  Amount total = 0;
+  for (const PlanNote &note : spendable) {
+    if (total >= amount) break;
+    inputs.push_back(note);
+    total += note.amount;
+  }
+  if (total < amount) throw std::runtime_error("plan payment: insufficient balance");
+
+  Plan plan;
+  if (inputs.size() % 2 == 1) {
+    if (inputs.size() < spendable.size()) {
+      inputs.push_back(spendable.back());
+    } else if (!zeros.empty()) {
+      inputs.push_back(zeros.front());
+    } else {
+      inputs.push_back(PlanNote{kPaddingMint, 0});
+      plan.padding_mints = 1;
+    }
+  }
+
+  // all but the last pair are below the amount (the notes were needed), so
+  // every proof pays something and only the last one has change
+  Amount remaining = amount;
+  for (size_t i = 0; i < inputs.size(); i += 2) {
+    TransferJob job;
+    job.inputs = {inputs[i], inputs[i + 1]};
+    Amount sum = inputs[i].amount + inputs[i + 1].amount;
+    job.pay = std::min(sum, remaining);
+    job.change = sum - job.pay;
+    remaining -= job.pay;
+    plan.jobs.push_back(job);
+  }
+  return plan;
+}
+
+// One round of consolidation: pairs the smallest notes, at most `max_jobs`
+// proofs and never below `target` notes. Outputs of a round are spendable
+// once included, so the next round is planned after confirmation.
+inline Plan PlanConsolidation(std::vector<PlanNote> notes, size_t target, size_t max_jobs) {
+  notes.erase(std::remove_if(notes.begin(), notes.end(),
+                             [](const PlanNote &note) { return note.amount == 0; }),
+              notes.end());
+  std::sort(notes.begin(), notes.end(), detail::LargerFirst);
+  std::reverse(notes.begin(), notes.end());
+
+  Plan plan;
+  if (notes.size() <= std::max<size_t>(target, 1)) return plan;
+  size_t jobs = std::min({max_jobs, notes.size() - std::max<size_t>(target, 1), notes.size() / 2});
+  for (size_t i = 0; i < jobs; i++) {
+    TransferJob job;
+    job.inputs = {notes[2 * i], notes[2 * i + 1]};
+    job.change = notes[2 * i].amount + notes[2 * i + 1].amount;
+    plan.jobs.push_back(job);
+  }
+  return plan;
+}
+
+// Runs consolidation in the wallet's idle time: at most one round in
+// flight, and none while a payment is being proven or is unconfirmed.
+class ConsolidationScheduler {
+ public:
+  ConsolidationScheduler(size_t target, size_t max_jobs) : target_(target), max_jobs_(max_jobs) {}
+
+  // Called from the wallet's idle loop with its unspent notes; an empty
+  // plan means there is nothing to do now.
+  Plan OnIdle(const std::vector<PlanNote> &notes) {
+    if (in_flight_ || payments_ > 0) return Plan();
+    Plan plan = PlanConsolidation(notes, target_, max_jobs_);
+    in_flight_ = !plan.jobs.empty();
+    return plan;
+  }
+
+  // the round was confirmed or dropped
+  void RoundDone() { in_flight_ = false; }
+
+  void PaymentStarted() { payments_++; }
+  void PaymentDone() { payments_--; }
+
+ private:
+  size_t target_;
+  size_t max_jobs_;
+  bool in_flight_ = false;
+  size_t payments_ = 0;
+};
+
+// Proves independent jobs of one plan on `threads` threads, results in job
+// order. `prove(job)` must be safe to call concurrently; the first
+// exception is rethrown after all threads have stopped.
+template <typename Result, typename Prove>
+std::vector<Result> ProveBatch(const std::vector<TransferJob> &jobs, size_t threads, Prove prove) {
+  std::vector<Result> results(jobs.size());
+  std::atomic<size_t> next{0};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto worker = [&]() {
+    for (size_t i = next++; i < jobs.size(); i = next++) {
+      try {
+        results[i] = prove(jobs[i]);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+        next = jobs.size();
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  size_t n = std::max<size_t>(1, std::min(threads, jobs.size()));
+  for (size_t i = 1; i < n; i++) pool.emplace_back(worker);
+  worker();
+  for (std::thread &t : pool) t.join();
+  if (error) std::rethrow_exception(error);
+  return results;
+}
+
+}  // namespace privacy
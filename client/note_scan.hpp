@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "field.hpp"
+#include "keccak.hpp"
+#include "mimc.hpp"
+
+namespace privacy {
+
+// A note as seen by its owner.
+struct Note {
+  Fr token_id;  // PrivacyPool notes only, zero otherwise
+  Fr amount;
+  Fr public_key;
+  Fr random;
+  Fr commitment;
+  uint64_t coin_index = 0;
+};
+
+// commitment = H(amount|publicKey|random), as in the circuits.
+inline Fr NoteCommitment(const Fr &amount, const Fr &public_key, const Fr &random) {
+  return Mimc::Hash({amount, public_key, random}, Fr());
+}
+
+// PrivacyPool notes bind the token id: H(tokenId|amount|publicKey|random).
+inline Fr PoolNoteCommitment(const Fr &token_id, const Fr &amount, const Fr &public_key,
+                             const Fr &random) {
+  return Mimc::Hash({token_id, amount, public_key, random}, Fr());
+}
+
+// The owner payload carried by `create` events is
+//
+//   [view tag : 1 byte][key exchange + ciphertext : rest]
+//
+// The tag is the first byte of keccak256("view tag" | shared secret). A
+// scanner still runs the key exchange for every note, but only opens the
+// ciphertext and recomputes the commitment when the tag matches, which
+// skips that work for 255 out of 256 foreign notes.
+//
+// The ciphertext holds the note's commitment preimage: (amount, pk, r) for
+// PrivacyArc20, (tokenId, amount, pk, r) for PrivacyPool. A pool transfer
+// does not reveal the token of its outputs, so the payload is the only
+// place the recipient learns it from; the sender encrypts the token id of
+// the spent notes. A pool mint also emits `deposit(tokenId, commitment)`.
+constexpr size_t kViewTagSize = 1;
+
+inline uint8_t ViewTag(const Keccak256::Digest &shared) {
+  static const char kDomain[] = "view tag";
+  Keccak256 k;
+  return k.Update(kDomain, sizeof(kDomain) - 1).Update(shared.data(), shared.size()).Final()[0];
+}
+
+inline std::vector<uint8_t> EncodeOwnerPayload(const Keccak256::Digest &shared,
+                                               const std::vector<uint8_t> &body) {
+  std::vector<uint8_t> payload;
+  payload.reserve(kViewTagSize + body.size());
+  payload.push_back(ViewTag(shared));
+  payload.insert(payload.end(), body.begin(), body.end());
+  return payload;
+}
+
+// The wallet's side of the owner encryption.
+class ViewKey {
+ public:
+  virtual ~ViewKey() = default;
+
+  // Key exchange against the sender's ephemeral key at the front of `body`.
+  virtual Keccak256::Digest SharedSecret(const uint8_t *body, size_t len) const = 0;
+
+  // Trial decryption of (amount, pk, r), or (tokenId, amount, pk, r) for
+  // PrivacyPool. Returns false when the plaintext does not hash to
+  // `commitment` (NoteCommitment or PoolNoteCommitment), i.e. the note is
+  // someone else's.
+  virtual bool Open(const Keccak256::Digest &shared, const uint8_t *body, size_t len,
+                    const Fr &commitment, Note *note) const = 0;
+};
+
+class NoteScanner {
+ public:
+  // `use_tags` = false reproduces the old behaviour, where every payload is
+  // trial-decrypted; kept for payloads emitted before tags existed.
+  explicit NoteScanner(const ViewKey &key, bool use_tags = true) : key_(key), use_tags_(use_tags) {}
+
+  // Returns true and fills `note` when the `create` event is ours.
+  bool Scan(const Fr &commitment, uint64_t coin_index, const uint8_t *payload, size_t len,
+            Note *note) {
+    if (len <= kViewTagSize) return false;
+    const uint8_t *body = payload + kViewTagSize;
+    size_t body_len = len - kViewTagSize;
+    Keccak256::Digest shared = key_.SharedSecret(body, body_len);
+    if (use_tags_ && ViewTag(shared) != payload[0]) {
+      skipped_++;
+      return false;
+    }
+    opened_++;
+    if (!key_.Open(shared, body, body_len, commitment, note)) return false;
+    note->coin_index = coin_index;
+    return true;
+  }
+
+  uint64_t skipped() const { return skipped_; }
+  uint64_t opened() const { return opened_; }
+
+ private:
+  const ViewKey &key_;
+  bool use_tags_;
+  uint64_t skipped_ = 0;
+  uint64_t opened_ = 0;
+};
+
+}  // namespace privacy
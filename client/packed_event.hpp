@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "field.hpp"
+
+namespace privacy {
+
+// Zero-copy view over the payload of PrivacyArc20's `packed` event; the
+// layout is documented next to PackedEvent in contract/common.hpp. Parse
+// checks every size once, the accessors then only compute offsets into
+// the caller's buffer, which must outlive the view.
+class PackedEventView {
+ public:
+  static constexpr uint8_t kVersion = 1;
+  static constexpr size_t kHeaderSize = 4;
+  static constexpr size_t kOutputSize = 76;
+  static constexpr size_t kNullifierSize = 32;
+
+  enum Action : uint8_t { kMint = 0, kTransfer = 1, kBurn = 2, kBurnPartial = 6 };
+
+  struct Output {
+    const uint8_t *commitment;  // 32 bytes big endian
+    const uint8_t *amount;      // 32 bytes big endian
+    uint64_t coin_index;
+    const uint8_t *owner;
+    size_t owner_size;
+  };
+
+  static bool Parse(const uint8_t *data, size_t size, PackedEventView *view) {
+    if (size < kHeaderSize || data[0] != kVersion) return false;
+    size_t outputs = data[2], nullifiers = data[3];
+    size_t owners = kHeaderSize + outputs * kOutputSize + nullifiers * kNullifierSize;
+    if (size < owners) return false;
+    for (size_t i = 0; i < outputs; i++) {
+      const uint8_t *record = data + kHeaderSize + i * kOutputSize;
+      if (owners + ReadLittleEndian(record + 72, 2) + ReadLittleEndian(record + 74, 2) > size) {
+        return false;
+      }
+    }
+    view->data_ = data;
+    view->size_ = size;
+    view->owners_ = owners;
+    return true;
+  }
+
+  Action action() const { return Action(data_[1]); }
+  size_t outputs() const { return data_[2]; }
+  size_t nullifiers() const { return data_[3]; }
+
+  Output output(size_t i) const {
+    const uint8_t *record = data_ + kHeaderSize + i * kOutputSize;
+    return Output{record, record + 32, ReadLittleEndian(record + 64, 8),
+                  data_ + owners_ + ReadLittleEndian(record + 72, 2),
+                  size_t(ReadLittleEndian(record + 74, 2))};
+  }
+
+  const uint8_t *nullifier(size_t i) const {
+    return data_ + kHeaderSize + outputs() * kOutputSize + i * kNullifierSize;
+  }
+
+  // Convenience for callers that need field elements rather than bytes.
+  static bool ToFr(const uint8_t *be, Fr *out) { return Fr::FromBytes(be, out); }
+
+ private:
+  static uint64_t ReadLittleEndian(const uint8_t *p, size_t size) {
+    uint64_t v = 0;
+    for (size_t i = size; i > 0; i--) v = (v << 8) | p[i - 1];
+    return v;
+  }
+
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+  size_t owners_ = 0;
+};
+
+}  // namespace privacy
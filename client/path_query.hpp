@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "field.hpp"
+#include "merkle_store.hpp"
+#include "mimc.hpp"
+
+namespace privacy {
+
+// Client copy of PrivacyArc20::getPaths. `indexes` are heap indices in
+// ascending order; nodes that are not listed are zero.
+struct MerklePaths {
+  Fr root;
+  std::vector<uint64_t> indexes;
+  std::vector<Fr> nodes;
+
+  Fr NodeAt(uint64_t index) const {
+    auto it = std::lower_bound(indexes.begin(), indexes.end(), index);
+    if (it == indexes.end() || *it != index) return Fr();
+    return nodes[it - indexes.begin()];
+  }
+
+  // Path for one of the requested leaves, in circuit order.
+  MerkleStore::Path PathFor(uint64_t coin_index) const {
+    MerkleStore::LeafFromCoinIndex(coin_index);
+    if (indexes.size() != nodes.size()) throw std::invalid_argument("merkle paths: malformed response");
+    MerkleStore::Path path;
+    uint64_t p = coin_index;
+    for (uint32_t level = 0; level < MerkleStore::kDepth; level++) {
+      path[level] = NodeAt(p % 2 == 0 ? p - 1 : p + 1);
+      p = (p - 1) / 2;
+    }
+    return path;
+  }
+};
+
+// Recomputes the root from a leaf and its path the way updatePathToRoot
+// does, so a client can check a response before proving against it.
+inline Fr RootFromPath(const Fr &commitment, uint64_t coin_index, const MerkleStore::Path &path) {
+  uint64_t leaf = MerkleStore::LeafFromCoinIndex(coin_index);
+  Fr node = commitment;
+  for (uint32_t level = 0; level < MerkleStore::kDepth; level++) {
+    node = ((leaf >> level) & 1) ? Mimc::Hash2(path[level], node) : Mimc::Hash2(node, path[level]);
+  }
+  return node;
+}
+
+}  // namespace privacy
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bn254.hpp"
+
+namespace privacy {
+
+// Compressed Groth16 proof: a (32 bytes), b (64 bytes), c (32 bytes),
+// encoded as in bn254.hpp. 128 bytes instead of the 256 of the coordinate
+// form, for storing and relaying proofs off chain. The contracts only take
+// a and c compressed, see ContractProof.
+constexpr size_t kCompressedProofSize = 128;
+using CompressedProof = std::array<uint8_t, kCompressedProofSize>;
+
+struct ProofPoints {
+  G1Affine a;
+  G2Affine b;
+  G1Affine c;
+};
+
+// Reads the proof of a `zokrates generate-proof` proof.json:
+//   "proof": {"a": [x, y], "b": [[x.c0, x.c1], [y.c0, y.c1]], "c": [x, y]}
+// (0, 0) is the point at infinity. Throws when the points are malformed
+// or not on the curve.
+inline ProofPoints ParseZokratesProof(const std::string &json) {
+  size_t pos = json.find("\"proof\"");
+  if (pos == std::string::npos) throw std::invalid_argument("proof json: no \"proof\" object");
+  pos += 6;  // closing quote of the key
+
+  std::vector<Fq> coords;
+  while (coords.size() < 8) {
+    size_t open = json.find('"', pos + 1);
+    if (open == std::string::npos) throw std::invalid_argument("proof json: truncated proof");
+    size_t close = json.find('"', open + 1);
+    if (close == std::string::npos) throw std::invalid_argument("proof json: truncated proof");
+    std::string token = json.substr(open + 1, close - open - 1);
+    pos = close;
+    if (token.size() < 2 || token[0] != '0' || token[1] != 'x') continue;  // keys
+    Fq f;
+    if (!Fq::FromString(token, &f)) throw std::invalid_argument("proof json: bad coordinate " + token);
+    coords.push_back(f);
+  }
+
+  ProofPoints p;
+  p.a = G1Affine{coords[0], coords[1], coords[0].IsZero() && coords[1].IsZero()};
+  p.b.x = Fq2{coords[2], coords[3]};
+  p.b.y = Fq2{coords[4], coords[5]};
+  p.b.infinity = p.b.x.IsZero() && p.b.y.IsZero();
+  p.c = G1Affine{coords[6], coords[7], coords[6].IsZero() && coords[7].IsZero()};
+  if (!OnCurve(p.a) || !OnCurve(p.b) || !OnCurve(p.c)) {
+    throw std::invalid_argument("proof json: point not on the curve");
+  }
+  return p;
+}
+
+inline CompressedProof CompressProof(const ProofPoints &p) {
+  CompressedProof out;
+  CompressG1(p.a, out.data());
+  CompressG2(p.b, out.data() + 32);
+  CompressG1(p.c, out.data() + 96);
+  return out;
+}
+
+// CompressedProof argument of the contracts' *Compressed actions (see
+// contract/compressed_proof.hpp): a and c compressed, b as x.c1, x.c0,
+// y.c1, y.c0. 192 bytes.
+struct ContractProof {
+  std::array<uint8_t, 32> a;
+  std::array<Fq, 4> b;
+  std::array<uint8_t, 32> c;
+};
+
+inline ContractProof ContractForm(const ProofPoints &p) {
+  ContractProof out;
+  CompressG1(p.a, out.a.data());
+  out.b = {p.b.x.c1, p.b.x.c0, p.b.y.c1, p.b.y.c0};
+  CompressG1(p.c, out.c.data());
+  return out;
+}
+
+// Checks that the points are on the curve and b is in the order r
+// subgroup, so a bad encoding is rejected before it is expanded and sent.
+inline bool DecompressProof(const CompressedProof &in, ProofPoints *out) {
+  return DecompressG1(in.data(), &out->a) && DecompressG2(in.data() + 32, &out->b) &&
+         DecompressG1(in.data() + 96, &out->c);
+}
+
+}  // namespace privacy
@@ -0,0 +1,73 @@
+// Prints the compressed form of zokrates proofs, for storing and relaying
+// them off chain (see client/proof_codec.hpp).
+//
+//   g++ -std=c++17 -O2 -I client client/tools/compress_proof.cpp -o compress_proof
+//   ./compress_proof [--contract] proof.json [proof.json ...]
+//
+// Every proof prints as one line "<a> <b> <c>", 0x-prefixed hex of 32, 64
+// and 32 bytes. The encoding is decompressed again before it is printed.
+// With --contract the line is the CompressedProof argument of the
+// *Compressed actions instead, "<a> <b.x.c1> <b.x.c0> <b.y.c1> <b.y.c0> <c>",
+// every word 32 bytes.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "proof_codec.hpp"
+
+namespace {
+
+std::string Hex(const uint8_t *p, size_t n) {
+  static const char kDigits[] = "0123456789abcdef";
+  std::string s = "0x";
+  for (size_t i = 0; i < n; i++) {
+    s += kDigits[p[i] >> 4];
+    s += kDigits[p[i] & 15];
+  }
+  return s;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool contract = argc > 1 && std::string(argv[1]) == "--contract";
+  int first = contract ? 2 : 1;
+  if (argc <= first) {
+    fprintf(stderr, "usage: %s [--contract] proof.json [proof.json ...]\n", argv[0]);
+    return 2;
+  }
+  for (int i = first; i < argc; i++) {
+    std::ifstream file(argv[i]);
+    if (!file) {
+      fprintf(stderr, "%s: cannot open\n", argv[i]);
+      return 1;
+    }
+    std::stringstream json;
+    json << file.rdbuf();
+    try {
+      privacy::ProofPoints points = privacy::ParseZokratesProof(json.str());
+      privacy::CompressedProof compressed = privacy::CompressProof(points);
+      privacy::ProofPoints check;
+      if (!privacy::DecompressProof(compressed, &check)) {
+        fprintf(stderr, "%s: proof point not in the subgroup\n", argv[i]);
+        return 1;
+      }
+      if (contract) {
+        privacy::ContractProof form = privacy::ContractForm(points);
+        printf("%s", Hex(form.a.data(), 32).c_str());
+        for (const privacy::Fq &word : form.b) printf(" %s", word.ToHex().c_str());
+        printf(" %s\n", Hex(form.c.data(), 32).c_str());
+        continue;
+      }
+      printf("%s %s %s\n", Hex(compressed.data(), 32).c_str(), Hex(compressed.data() + 32, 64).c_str(),
+             Hex(compressed.data() + 96, 32).c_str());
+    } catch (const std::exception &e) {
+      fprintf(stderr, "%s: %s\n", argv[i], e.what());
+      return 1;
+    }
+  }
+  return 0;
+}
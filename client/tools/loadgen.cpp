@@ -0,0 +1,384 @@
+// Synthetic load for the mint -> transfer -> burn lifecycle.
+//
+//   g++ -std=c++17 -O2 -pthread -I client client/tools/loadgen.cpp client/merkle_store.cpp client/mimc_batch.cpp -o loadgen
+//   ./loadgen generate --cycles 10000 [--proofs] [--circuits code] [--zokrates zokrates]
+//   ./loadgen replay --rate 200 [--report 5]
+//
+// `generate` builds a valid workload: every cycle mints two notes, spends
+// both in a transfer (payment to another user plus change) and burns the
+// payment. Keys, commitments, nullifiers and Merkle paths are computed with
+// the same MiMC as the circuits. With --proofs every transaction also gets a
+// Groth16 proof from `zokrates compute-witness` / `generate-proof` using
+// <circuits>/<action>/out and proving.key. Everything is cached under
+// --fixtures (default ./fixtures): workload.txt plus proofs/<seq>.json, and
+// existing proofs are reused.
+//
+// `replay` feeds the workload open-loop at --rate transactions per second
+// into an in-memory model of PrivacyArc20 (tree, root history, nullifiers,
+// same checks as the contract, proofs are not verified) and reports
+// throughput, latency percentiles and the size the contract's StorageType
+// state would have. Pointing replay at a local chain requires a signing RPC
+// client and is not part of this tool.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "merkle_store.hpp"
+#include "mimc.hpp"
+
+using namespace privacy;
+
+namespace {
+
+struct Options {
+  std::string command;
+  std::string fixtures = "fixtures";
+  std::string circuits = "code";
+  std::string zokrates = "zokrates";
+  uint64_t cycles = 1000;
+  uint64_t seed = 1;
+  bool proofs = false;
+  double rate = 100;
+  double report = 5;
+};
+
+// Inputs are laid out as PrivacyArc20 reads them, followed by the circuit
+// output (1):
+//   mint      amount, commitment, output
+//   transfer  nullifierA, nullifierB, commitmentC, amountC, commitmentD,
+//             amountD, root, output
+//   burn      amount, nullifier, root, output
+// For mint and burn that is the circuit's order; the transfer circuit takes
+// its ten public inputs in another order, which only the prover sees.
+struct Tx {
+  std::string action;
+  std::vector<Fr> inputs;  // public inputs as the contract takes them
+  std::string proof;       // proof file, empty when generated without proofs
+};
+
+// ---------------------------------------------------------------------------
+// workload generation
+
+struct Owner {
+  Fr secret_key;
+  Fr public_key;
+};
+
+struct OwnedNote {
+  Owner owner;
+  Fr amount, random, commitment;
+  uint64_t leaf;
+};
+
+class Generator {
+ public:
+  Generator(const Options &options, const std::string &tree_file)
+      : options_(options), rng_(options.seed), tree_(tree_file) {}
+
+  std::vector<Tx> Run() {
+    std::vector<Tx> txs;
+    for (uint64_t cycle = 0; cycle < options_.cycles; cycle++) {
+      Owner payer = NewOwner(), payee = NewOwner();
+      uint64_t amount_a = 1 + rng_() % 1000000, amount_b = 1 + rng_() % 1000000;
+      OwnedNote a = Mint(payer, amount_a, &txs);
+      OwnedNote b = Mint(payer, amount_b, &txs);
+      // at most the inputs, the change must not wrap around the field
+      uint64_t total = amount_a + amount_b, paid = 1 + rng_() % total;
+      OwnedNote c = Transfer(a, b, payee, Fr::FromUint64(paid), Fr::FromUint64(total - paid), &txs);
+      Burn(c, &txs);
+    }
+    return txs;
+  }
+
+ private:
+  Fr RandomFr() { return Fr::FromWide(Limbs{rng_(), rng_(), rng_(), rng_() >> 3}); }
+
+  Owner NewOwner() {
+    Owner o;
+    o.secret_key = RandomFr();
+    o.public_key = Mimc::Hash({o.secret_key}, Fr());
+    return o;
+  }
+
+  OwnedNote NewNote(const Owner &owner, const Fr &amount) {
+    OwnedNote n;
+    n.owner = owner;
+    n.amount = amount;
+    n.random = RandomFr();
+    n.commitment = Mimc::Hash({amount, owner.public_key, n.random}, Fr());
+    n.leaf = tree_.Count();
+    tree_.Append({n.commitment});
+    return n;
+  }
+
+  static Fr Nullifier(const OwnedNote &n) { return Mimc::Hash({n.owner.secret_key, n.random}, Fr()); }
+
+  void AppendPath(const OwnedNote &n, std::vector<Fr> *args) {
+    MerkleStore::Path path = tree_.GetPath(n.leaf);
+    args->insert(args->end(), path.begin(), path.end());
+  }
+
+  OwnedNote Mint(const Owner &owner, uint64_t value, std::vector<Tx> *txs) {
+    OwnedNote n = NewNote(owner, Fr::FromUint64(value));
+    Tx tx{"mint", {n.amount, n.commitment, Fr::One()}, ""};
+    Prove(&tx, {n.amount, n.commitment}, {owner.public_key, n.random}, txs->size());
+    txs->push_back(tx);
+    return n;
+  }
+
+  OwnedNote Transfer(const OwnedNote &a, const OwnedNote &b, const Owner &payee, const Fr &paid,
+                     const Fr &change, std::vector<Tx> *txs) {
+    Fr root = tree_.Root();
+    std::vector<Fr> witness{a.owner.secret_key, a.random};
+    AppendPath(a, &witness);
+    witness.push_back(b.random);
+    AppendPath(b, &witness);
+
+    OwnedNote c = NewNote(payee, paid);
+    OwnedNote d = NewNote(a.owner, change);
+    witness.insert(witness.end(), {payee.public_key, c.random, d.random});
+
+    Fr na = Nullifier(a), nb = Nullifier(b);
+    Tx tx{"transfer", {na, nb, c.commitment, c.amount, d.commitment, d.amount, root, Fr::One()}, ""};
+    Prove(&tx,
+          {a.amount, na, root, b.amount, nb, root, c.amount, c.commitment, d.amount, d.commitment},
+          witness, txs->size());
+    txs->push_back(tx);
+    return c;
+  }
+
+  void Burn(const OwnedNote &n, std::vector<Tx> *txs) {
+    std::vector<Fr> witness{n.owner.secret_key, n.random};
+    AppendPath(n, &witness);
+    Tx tx{"burn", {n.amount, Nullifier(n), tree_.Root(), Fr::One()}, ""};
+    Prove(&tx, {n.amount, Nullifier(n), tree_.Root()}, witness, txs->size());
+    txs->push_back(tx);
+  }
+
+  // `args` are the circuit's public inputs in its own order
+  void Prove(Tx *tx, const std::vector<Fr> &args, const std::vector<Fr> &witness, size_t seq) {
+    if (!options_.proofs) return;
+    std::string proof = options_.fixtures + "/proofs/" + std::to_string(seq) + ".json";
+    tx->proof = proof;
+    if (access(proof.c_str(), R_OK) == 0) return;
+
+    std::string program = options_.circuits + "/" + tx->action + "/out";
+    std::string key = options_.circuits + "/" + tx->action + "/proving.key";
+    std::string witness_file = options_.fixtures + "/proofs/witness";
+    std::ostringstream cmd;
+    cmd << options_.zokrates << " compute-witness -i " << program << " -o " << witness_file << " -a";
+    for (const Fr &x : args) cmd << ' ' << x.ToDecimal();
+    for (const Fr &x : witness) cmd << ' ' << x.ToDecimal();
+    cmd << " > /dev/null && " << options_.zokrates << " generate-proof -i " << program << " -w "
+        << witness_file << " -p " << key << " -j " << proof << " > /dev/null";
+    if (std::system(cmd.str().c_str()) != 0) {
+      throw std::runtime_error("proving " + tx->action + " #" + std::to_string(seq) + " failed");
+    }
+  }
+
+  const Options &options_;
+  std::mt19937_64 rng_;
+  MerkleStore tree_;
+};
+
+void WriteWorkload(const std::string &file, const std::vector<Tx> &txs) {
+  std::ofstream out(file);
+  for (const Tx &tx : txs) {
+    out << tx.action << ' ' << tx.inputs.size();
+    for (const Fr &x : tx.inputs) out << ' ' << x.ToDecimal();
+    out << ' ' << (tx.proof.empty() ? "-" : tx.proof) << '\n';
+  }
+  if (!out) throw std::runtime_error("writing " + file + " failed");
+}
+
+std::vector<Tx> ReadWorkload(const std::string &file) {
+  std::ifstream in(file);
+  if (!in) throw std::runtime_error("no workload at " + file + ", run generate first");
+  std::vector<Tx> txs;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    Tx tx;
+    size_t n;
+    fields >> tx.action >> n;
+    tx.inputs.resize(n);
+    for (Fr &x : tx.inputs) {
+      std::string s;
+      fields >> s;
+      if (!Fr::FromString(s, &x)) throw std::runtime_error("bad field element in " + file);
+    }
+    fields >> tx.proof;
+    if (!fields) throw std::runtime_error("malformed line in " + file + ": " + line);
+    if (tx.proof == "-") tx.proof.clear();
+    txs.push_back(tx);
+  }
+  return txs;
+}
+
+// ---------------------------------------------------------------------------
+// in-memory stand-in for PrivacyArc20
+
+class MemoryChain {
+ public:
+  explicit MemoryChain(const std::string &tree_file) : tree_(tree_file) {}
+
+  void Apply(const Tx &tx) {
+    const std::vector<Fr> &in = tx.inputs;
+    auto it = kInputs.find(tx.action);
+    if (it == kInputs.end()) throw std::runtime_error("unknown action " + tx.action);
+    if (in.size() != it->second) {
+      throw std::runtime_error(tx.action + ": unexpected number of inputs");
+    }
+    if (tx.action == "mint") {
+      Append({in[1]});
+    } else if (tx.action == "transfer") {
+      CheckRoot(in[6]);
+      if (in[0] == in[1]) throw std::runtime_error("Repeated input");
+      if (in[2] == in[4]) throw std::runtime_error("Repeated output");
+      Spend(in[0]);
+      Spend(in[1]);
+      Append({in[2], in[4]});
+    } else {
+      CheckRoot(in[2]);
+      Spend(in[1]);
+    }
+  }
+
+  // Bytes the contract's StorageType members would serialize: the node
+  // map holds the leaves, every node above at least one leaf and the root;
+  // CommitmentTree reads missing siblings as zero without inserting them.
+  uint64_t StateBytes() const {
+    uint64_t n = tree_.Count(), entries = n == 0 ? 0 : 1;
+    for (uint32_t level = 0; level < MerkleStore::kDepth && n > 0; level++) {
+      entries += (n + (1ull << level) - 1) >> level;
+    }
+    return entries * (8 + 32) + (roots_.size() + nullifiers_.size() + n) * 32 + 8;
+  }
+
+ private:
+  // inputs per action, including the circuit output, see Tx
+  const std::map<std::string, size_t> kInputs = {{"mint", 3}, {"transfer", 8}, {"burn", 4}};
+
+  void CheckRoot(const Fr &root) {
+    if (roots_.count(root.ToHex()) == 0) throw std::runtime_error("invalid merkle tree root");
+  }
+
+  void Spend(const Fr &nullifier) {
+    if (!nullifiers_.insert(nullifier.ToHex()).second) throw std::runtime_error("It has been spent");
+  }
+
+  void Append(const std::vector<Fr> &commitments) {
+    tree_.Append(commitments);
+    roots_.insert(tree_.Root().ToHex());
+  }
+
+  MerkleStore tree_;
+  std::set<std::string> roots_;
+  std::set<std::string> nullifiers_;
+};
+
+double Percentile(std::vector<double> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  return v[size_t(p * (v.size() - 1) + 0.5)];
+}
+
+void Replay(const Options &options, const std::vector<Tx> &txs) {
+  using Clock = std::chrono::steady_clock;
+  std::string tree_file = options.fixtures + "/replay.tree";
+  unlink(tree_file.c_str());
+  MemoryChain chain(tree_file);
+
+  printf("%8s %8s %10s %10s %10s %10s %14s\n", "time s", "txs", "tps", "p50 ms", "p95 ms",
+         "p99 ms", "state bytes");
+  std::vector<double> window;
+  Clock::time_point start = Clock::now(), last = start;
+  size_t last_count = 0;
+  auto report = [&](Clock::time_point now, size_t done) {
+    double elapsed = std::chrono::duration<double>(now - start).count();
+    double span = std::chrono::duration<double>(now - last).count();
+    printf("%8.1f %8zu %10.1f %10.2f %10.2f %10.2f %14llu\n", elapsed, done,
+           span > 0 ? (done - last_count) / span : 0, Percentile(window, 0.5),
+           Percentile(window, 0.95), Percentile(window, 0.99),
+           (unsigned long long)chain.StateBytes());
+    window.clear();
+    last = now;
+    last_count = done;
+  };
+
+  for (size_t i = 0; i < txs.size(); i++) {
+    // open loop: latency counts from the scheduled send time, so a sink that
+    // falls behind shows up as queueing delay rather than a lower rate
+    Clock::time_point due = start + std::chrono::duration_cast<Clock::duration>(
+                                        std::chrono::duration<double>(i / options.rate));
+    if (Clock::now() < due) std::this_thread::sleep_until(due);
+    chain.Apply(txs[i]);
+    Clock::time_point done = Clock::now();
+    window.push_back(std::chrono::duration<double, std::milli>(done - due).count());
+    if (std::chrono::duration<double>(done - last).count() >= options.report) report(done, i + 1);
+  }
+  report(Clock::now(), txs.size());
+}
+
+Options Parse(int argc, char **argv) {
+  Options o;
+  if (argc < 2) throw std::invalid_argument("usage: loadgen generate|replay [options]");
+  o.command = argv[1];
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) throw std::invalid_argument(arg + " needs a value");
+      return argv[++i];
+    };
+    if (arg == "--fixtures") o.fixtures = value();
+    else if (arg == "--circuits") o.circuits = value();
+    else if (arg == "--zokrates") o.zokrates = value();
+    else if (arg == "--cycles") o.cycles = std::stoull(value());
+    else if (arg == "--seed") o.seed = std::stoull(value());
+    else if (arg == "--rate") o.rate = std::stod(value());
+    else if (arg == "--report") o.report = std::stod(value());
+    else if (arg == "--proofs") o.proofs = true;
+    else throw std::invalid_argument("unknown option " + arg);
+  }
+  if (o.rate <= 0) throw std::invalid_argument("--rate must be positive");
+  return o;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  try {
+    Options options = Parse(argc, argv);
+    std::string workload = options.fixtures + "/workload.txt";
+    if (options.command == "generate") {
+      std::system(("mkdir -p " + options.fixtures + "/proofs").c_str());
+      std::string tree_file = options.fixtures + "/generate.tree";
+      unlink(tree_file.c_str());
+      Generator generator(options, tree_file);
+      std::vector<Tx> txs = generator.Run();
+      WriteWorkload(workload, txs);
+      printf("%zu transactions written to %s\n", txs.size(), workload.c_str());
+    } else if (options.command == "replay") {
+      Replay(options, ReadWorkload(workload));
+    } else {
+      throw std::invalid_argument("unknown command " + options.command);
+    }
+  } catch (const std::exception &e) {
+    fprintf(stderr, "loadgen: %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Aggregates PrivacyProfileEvent records of a profiling run (contracts
+// built with -DPRIVACY_PROFILE, see contract/common.hpp).
+//
+//   g++ -std=c++17 -O2 client/tools/profile_report.cpp -o profile_report
+//   ./profile_report < phases.txt
+//
+// Input is one decoded phase per line, "<tx> <action> <phase> <gas> <bytes>",
+// e.g. as printed by an event-log dump of the run; lines starting with '#'
+// are skipped. For every action the report lists each phase's gas (mean,
+// p50, p95, max), its share of the action's total gas, and the contract's
+// estimate of the state bytes it wrote (PhaseCost::estimatedStateBytes, not
+// a measurement).
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Samples {
+  std::vector<uint64_t> gas;
+  std::vector<uint64_t> bytes;
+};
+
+uint64_t Percentile(std::vector<uint64_t> v, double p) {
+  if (v.empty()) return 0;
+  std::sort(v.begin(), v.end());
+  size_t i = size_t(p * (v.size() - 1) + 0.5);
+  return v[i];
+}
+
+double Mean(const std::vector<uint64_t> &v) {
+  if (v.empty()) return 0;
+  double sum = 0;
+  for (uint64_t x : v) sum += double(x);
+  return sum / v.size();
+}
+
+}  // namespace
+
+int main() {
+  // action -> phases in first-seen order, phase -> samples
+  std::map<std::string, std::vector<std::string>> order;
+  std::map<std::string, std::map<std::string, Samples>> samples;
+  std::map<std::string, std::set<std::string>> txs;
+
+  std::string line;
+  size_t lineno = 0;
+  while (std::getline(std::cin, line)) {
+    lineno++;
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream in(line);
+    std::string tx, action, phase;
+    uint64_t gas, bytes;
+    if (!(in >> tx >> action >> phase >> gas >> bytes)) {
+      fprintf(stderr, "line %zu: expected <tx> <action> <phase> <gas> <bytes>\n", lineno);
+      return 1;
+    }
+    auto &phases = samples[action];
+    if (phases.find(phase) == phases.end()) order[action].push_back(phase);
+    phases[phase].gas.push_back(gas);
+    phases[phase].bytes.push_back(bytes);
+    txs[action].insert(tx);
+  }
+
+  for (const auto &entry : order) {
+    const std::string &action = entry.first;
+    double total = 0;
+    for (const std::string &phase : entry.second) {
+      const Samples &s = samples[action][phase];
+      for (uint64_t g : s.gas) total += double(g);
+    }
+
+    printf("%s: %zu transactions, mean gas %.0f\n", action.c_str(), txs[action].size(),
+           total / txs[action].size());
+    printf("  %-10s %12s %12s %12s %12s %7s %12s %12s\n", "phase", "gas mean", "gas p50",
+           "gas p95", "gas max", "share", "est. bytes", "est. max");
+    for (const std::string &phase : entry.second) {
+      const Samples &s = samples[action][phase];
+      double sum = Mean(s.gas) * s.gas.size();
+      printf("  %-10s %12.0f %12llu %12llu %12llu %6.1f%% %12.0f %12llu\n", phase.c_str(),
+             Mean(s.gas), (unsigned long long)Percentile(s.gas, 0.5),
+             (unsigned long long)Percentile(s.gas, 0.95),
+             (unsigned long long)Percentile(s.gas, 1.0), total > 0 ? 100 * sum / total : 0.0,
+             Mean(s.bytes), (unsigned long long)Percentile(s.bytes, 1.0));
+    }
+  }
+  return 0;
+}
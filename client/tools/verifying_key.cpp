@@ -0,0 +1,96 @@
+// Prints a zokrates verification.key as the key argument of
+// Verify::setVerifyingKey, for the circuits without a verifier built into
+// contract/verify.cpp (code/pool, code/burn-partial).
+//
+//   g++ -std=c++17 -O2 -I client client/tools/verifying_key.cpp -o verifying_key
+//   ./verifying_key verification.key
+//
+// Prints one JSON array of 0x-prefixed words: alpha x, y; beta, gamma and
+// delta as x.c1, x.c0, y.c1, y.c0 (zokrates writes c0 first); then x, y of
+// every gamma_abc point. Every point is checked to be on the curve.
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bn254.hpp"
+
+namespace {
+
+// the 0x-prefixed strings of the file, in order
+std::vector<std::string> Words(const std::string &json) {
+  std::vector<std::string> words;
+  for (size_t open = json.find('"'); open != std::string::npos; open = json.find('"', open + 1)) {
+    size_t close = json.find('"', open + 1);
+    if (close == std::string::npos) throw std::invalid_argument("verification key: unterminated string");
+    std::string token = json.substr(open + 1, close - open - 1);
+    if (token.size() > 2 && token[0] == '0' && token[1] == 'x') words.push_back(token);
+    open = close;
+  }
+  return words;
+}
+
+privacy::Fq Coordinate(const std::string &word) {
+  privacy::Fq f;
+  if (!privacy::Fq::FromString(word, &f)) throw std::invalid_argument("verification key: bad coordinate " + word);
+  return f;
+}
+
+// G1 at words[i], appended as x, y
+void AddG1(const std::vector<std::string> &words, size_t i, std::vector<std::string> *out) {
+  privacy::G1Affine p{Coordinate(words[i]), Coordinate(words[i + 1])};
+  if (!privacy::OnCurve(p)) throw std::invalid_argument("verification key: G1 point not on the curve");
+  out->push_back(words[i]);
+  out->push_back(words[i + 1]);
+}
+
+// G2 at words[i] as [[x.c0, x.c1], [y.c0, y.c1]], appended as x.c1, x.c0, y.c1, y.c0
+void AddG2(const std::vector<std::string> &words, size_t i, std::vector<std::string> *out) {
+  privacy::G2Affine p;
+  p.x = privacy::Fq2{Coordinate(words[i]), Coordinate(words[i + 1])};
+  p.y = privacy::Fq2{Coordinate(words[i + 2]), Coordinate(words[i + 3])};
+  if (!privacy::OnCurve(p)) throw std::invalid_argument("verification key: G2 point not on the curve");
+  out->push_back(words[i + 1]);
+  out->push_back(words[i]);
+  out->push_back(words[i + 3]);
+  out->push_back(words[i + 2]);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s verification.key\n", argv[0]);
+    return 2;
+  }
+  std::ifstream file(argv[1]);
+  if (!file) {
+    fprintf(stderr, "%s: cannot open\n", argv[1]);
+    return 1;
+  }
+  std::stringstream json;
+  json << file.rdbuf();
+  try {
+    // alpha, beta, gamma, delta, gamma_abc in the order zokrates writes them
+    std::vector<std::string> words = Words(json.str());
+    if (words.size() < 16 || words.size() % 2 != 0) {
+      throw std::invalid_argument("verification key: unexpected number of coordinates");
+    }
+    std::vector<std::string> key;
+    AddG1(words, 0, &key);
+    for (size_t i = 2; i < 14; i += 4) AddG2(words, i, &key);
+    for (size_t i = 14; i < words.size(); i += 2) AddG1(words, i, &key);
+
+    printf("[");
+    for (size_t i = 0; i < key.size(); i++) printf("%s\"%s\"", i == 0 ? "" : ",", key[i].c_str());
+    printf("]\n");
+    fprintf(stderr, "%zu gamma_abc points\n", (key.size() - 14) / 2);
+  } catch (const std::exception &e) {
+    fprintf(stderr, "%s: %s\n", argv[1], e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include "field.hpp"
+#include "frontier.hpp"
+#include "merkle_store.hpp"
+#include "mimc.hpp"
+#include "path_query.hpp"
+
+namespace privacy {
+
+// Merkle path of one note kept current as later leaves are appended, so a
+// spend can prove against the latest root without rebuilding the tree.
+//
+// Siblings that are left of the note never change and are taken from the
+// frontier when the note is appended. Right siblings fill up in order of
+// level: later leaves first complete the sibling subtree at the lowest
+// level whose bit in the note's position is zero, then the next one, and
+// so on. The subtree being filled is kept as a small frontier (the
+// cursor); once complete its root becomes a fixed path entry. Appending
+// costs amortized O(1) hashes, Path() O(kDepth).
+class IncrementalWitness {
+ public:
+  static constexpr uint32_t kDepth = MerkleStore::kDepth;
+
+  // `tree` is the frontier before the note's leaf was appended.
+  IncrementalWitness(const Frontier &tree, const Fr &commitment) : leaf_(tree.Count()), commitment_(commitment) {
+    if (leaf_ == MerkleStore::kWidth) throw std::length_error("witness: tree is full");
+    for (uint32_t level = 0; level < kDepth; level++) {
+      if ((leaf_ >> level) & 1) path_[level] = tree.LeftSibling(level);
+    }
+    cursor_level_ = NextLevel(0);
+  }
+
+  uint64_t CoinIndex() const { return MerkleStore::CoinIndexFromLeaf(leaf_); }
+  const Fr &Commitment() const { return commitment_; }
+
+  // Leaf appended after the note, in order.
+  void Append(const Fr &commitment) {
+    if (cursor_level_ == kDepth) throw std::length_error("witness: tree is full");
+    Fr node = commitment;
+    uint32_t level = 0;
+    for (; (cursor_count_ >> level) & 1; level++) node = Mimc::Hash2(cursor_[level], node);
+    cursor_[level] = node;
+    cursor_count_++;
+    if (cursor_count_ == (uint64_t(1) << cursor_level_)) {
+      path_[cursor_level_] = node;
+      cursor_count_ = 0;
+      cursor_level_ = NextLevel(cursor_level_ + 1);
+    }
+  }
+
+  // Sibling hashes in circuit order, see MerkleStore::GetPath.
+  MerkleStore::Path Path() const {
+    MerkleStore::Path path = path_;
+    if (cursor_count_ > 0) path[cursor_level_] = CursorRoot();
+    return path;
+  }
+
+  Fr Root() const { return RootFromPath(commitment_, CoinIndex(), Path()); }
+
+ private:
+  // lowest level from `level` on where the note's ancestor is a left child
+  uint32_t NextLevel(uint32_t level) const {
+    while (level < kDepth && ((leaf_ >> level) & 1)) level++;
+    return level;
+  }
+
+  // Root of the partially filled sibling subtree. As in the contract, a
+  // node is zero until a leaf below it is written.
+  Fr CursorRoot() const {
+    Fr node;
+    bool empty = true;
+    for (uint32_t level = 0; level < cursor_level_; level++) {
+      if ((cursor_count_ >> level) & 1) {
+        node = Mimc::Hash2(cursor_[level], node);
+        empty = false;
+      } else if (!empty) {
+        node = Mimc::Hash2(node, Fr());
+      }
+    }
+    return node;
+  }
+
+  uint64_t leaf_;
+  Fr commitment_;
+  MerkleStore::Path path_{};        // left siblings and completed right siblings
+  uint32_t cursor_level_ = 0;        // level of the sibling being filled
+  uint64_t cursor_count_ = 0;        // leaves in it so far
+  std::array<Fr, kDepth> cursor_{};  // its full subtrees, by height
+};
+
+// A wallet's view of the tree: a frontier plus a witness for every unspent
+// note it owns. Notes have to be recognized (see note_scan.hpp) when their
+// `create` event is applied, since the witness starts from the frontier at
+// that point. In epoch mode the witness root is accepted once the block's
+// root has been committed.
+class WitnessSet {
+ public:
+  explicit WitnessSet(const Frontier &tree) : tree_(tree) {}
+
+  const Frontier &Tree() const { return tree_; }
+
+  // Follows a `create` event; `owned` adds a witness for the new note.
+  // Events at or before the frontier are ignored, a gap throws.
+  void ApplyCreate(const Fr &commitment, uint64_t coin_index, bool owned) {
+    uint64_t leaf = MerkleStore::LeafFromCoinIndex(coin_index);
+    if (leaf < tree_.Count()) return;
+    if (leaf > tree_.Count()) {
+      throw std::runtime_error("witness set: missing create events before leaf " + std::to_string(leaf));
+    }
+    for (auto &entry : witnesses_) entry.second.Append(commitment);
+    if (owned) witnesses_.emplace(coin_index, IncrementalWitness(tree_, commitment));
+    tree_.Append(commitment);
+  }
+
+  // nullptr when the note is not tracked
+  const IncrementalWitness *Find(uint64_t coin_index) const {
+    auto it = witnesses_.find(coin_index);
+    return it == witnesses_.end() ? nullptr : &it->second;
+  }
+
+  // Stops updating a note, once its nullifier is seen.
+  void Forget(uint64_t coin_index) { witnesses_.erase(coin_index); }
+
+  size_t Size() const { return witnesses_.size(); }
+
+ private:
+  Frontier tree_;
+  std::map<uint64_t, IncrementalWitness> witnesses_;
+};
+
+}  // namespace privacy
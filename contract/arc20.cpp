@@ -1,6 +1,14 @@
+#include <map>
 #include <string>
 #include "common.hpp"
 
+// Chain that permit signatures are bound to, so a permit can not be
+// replayed on another chain where the token has the same address. Build
+// with -DPRIVACY_CHAIN_ID=<id> for chains other than PlatON mainnet.
+#ifndef PRIVACY_CHAIN_ID
+#define PRIVACY_CHAIN_ID 210425
+#endif
+
 using namespace platon;
 
 CONTRACT ARC20 : public Contract {
@@ -9,6 +17,9 @@ CONTRACT ARC20 : public Contract {
   PLATON_EVENT2(TransferEvent, const Address&, const Address&, u128);
   // define: _owner, _spender, _value
   PLATON_EVENT2(ApprovalEvent, const Address&, const Address&, u128);
+  // define: _from, [(_to, _value)], one event per batch
+  PLATON_EVENT1(BatchTransferEvent, const Address &,
+                const std::vector<std::pair<Address, u128>> &);
  public:
   ACTION void init(const std::string &token_name,
                    const std::string &token_symbol, u128 initial_amount,
@@ -28,9 +39,9 @@ CONTRACT ARC20 : public Contract {
     SetTotalSupply(initial_amount);
     SetDecimals(decimal_units);  // Amount of decimals for display purposes
 
-    DEBUG("init", "name:", token_name, "Symbol:", token_symbol,
-          "total:", initial_amount, "_Decimal:", decimal_units,
-          "owner:", sender.toString());
+    TRACE_ACTION("init", "name:", token_name, "Symbol:", token_symbol, "total:",
+                 initial_amount, "_Decimal:", decimal_units, "owner:",
+                 sender.toString());
   }
 
   CONST std::string GetName() {
@@ -41,7 +52,7 @@ CONTRACT ARC20 : public Contract {
     name.resize(len);
     ::platon_get_state((const uint8_t *)&kNameKey, sizeof(kNameKey),
                        (byte *)name.data(), name.length());
-    DEBUG("name:", name);
+    TRACE_ACTION("get name", "name:", name);
     return name;
   }
 
@@ -54,7 +65,7 @@ CONTRACT ARC20 : public Contract {
     symbol.resize(len);
     ::platon_get_state((const uint8_t *)&kSymbol, sizeof(kSymbol),
                        (byte *)symbol.data(), symbol.length());
-    DEBUG("symbol:", symbol);
+    TRACE_ACTION("get symbol", "symbol:", symbol);
     return symbol;
   }
 
@@ -64,7 +75,7 @@ CONTRACT ARC20 : public Contract {
     uint8_t decimals;
     ::platon_get_state((const uint8_t *)&kDecimals, sizeof(kDecimals),
                        (byte *)&decimals, sizeof(decimals));
-    DEBUG("decimals:", decimals);
+    TRACE_ACTION("get decimals", "decimals:", decimals);
     return decimals;
   }
 
@@ -80,8 +91,8 @@ CONTRACT ARC20 : public Contract {
     platon_get_state(combine_addr.data(), combine_addr.size, (byte *)&balance,
                      sizeof(balance));
 
-    DEBUG("allowance", "owner:", owner.toString(),
-          "spender:", spender.toString(), "balance:", balance);
+    TRACE_ACTION("allowance", "owner:", owner.toString(), "spender:",
+                 spender.toString(), "balance:", balance);
     return balance;
   }
 
@@ -99,8 +110,47 @@ CONTRACT ARC20 : public Contract {
     SetBalance(sender, sender_balance - value);
     SetBalance(to, to_balance + value);
     PLATON_EMIT_EVENT2(TransferEvent, sender, to, value);
-    DEBUG("transfer", "sender:", sender.toString(), "to:", to.toString(),
-          "value:", value);
+    TRACE_ACTION("transfer", "sender:", sender.toString(), "to:", to.toString(),
+                 "value:", value);
+    return true;
+  }
+
+  ACTION bool BatchTransfer(
+      const std::vector<std::pair<Address, u128>> &transfers) {
+    privacy_assert(!transfers.empty(), "PlatON ARC20: empty batch transfer");
+
+    // Merge duplicate recipients so that every balance, the sender's
+    // included, is read and written exactly once.
+    std::map<Address, u128> merged;
+    u128 total = 0;
+    for (const auto &transfer : transfers) {
+      privacy_assert(transfer.second > 0,
+                     "PlatON ARC20: transfer amount illegal");
+      privacy_assert(total + transfer.second > total,
+                     "PlatON ARC20: batch transfer amount overflow");
+      total += transfer.second;
+      merged[transfer.first] += transfer.second;
+    }
+
+    Address sender = platon_caller();
+    u128 sender_balance = GetBalance(sender);
+    privacy_assert(sender_balance >= total,
+                   "PlatON ARC20: transfer amount exceeds balance");
+    sender_balance -= total;
+
+    std::vector<std::pair<Address, u128>> paid(merged.begin(), merged.end());
+    for (const auto &transfer : paid) {
+      if (transfer.first == sender) {
+        sender_balance += transfer.second;
+      } else {
+        SetBalance(transfer.first, GetBalance(transfer.first) + transfer.second);
+      }
+    }
+    SetBalance(sender, sender_balance);
+
+    PLATON_EMIT_EVENT1(BatchTransferEvent, sender, paid);
+    TRACE_ACTION("batch transfer", "sender:", sender.toString(),
+                 "recipients:", paid.size(), "value:", total);
     return true;
   }
 
@@ -119,8 +169,8 @@ CONTRACT ARC20 : public Contract {
     SetAllowance(from, sender, from_sender_allowance - value);
 
     PLATON_EMIT_EVENT2(TransferEvent, from, to, value);
-    DEBUG("transfer from", "sender:", sender.toString(),
-          "from:", from.toString(), "to:", to.toString(), "value:", value);
+    TRACE_ACTION("transfer from", "sender:", sender.toString(), "from:",
+                 from.toString(), "to:", to.toString(), "value:", value);
     return true;
   }
 
@@ -129,11 +179,40 @@ CONTRACT ARC20 : public Contract {
     privacy_assert(value > 0, "PlatON ARC20: approve amount illegal");
     SetAllowance(sender, spender, value);
     PLATON_EMIT_EVENT2(ApprovalEvent, sender, spender, value);
-    DEBUG("approve", "sender:", sender.toString(),
-          "spender:", spender.toString(), "value:", value);
+    TRACE_ACTION("approve", "sender:", sender.toString(), "spender:",
+                 spender.toString(), "value:", value);
+    return true;
+  }
+
+  // Approve on behalf of `owner`, who signed
+  //   sha3("permit" | chainId | token | owner | spender | value | nonce
+  //        | deadline)
+  // with chainId, value, nonce and deadline little endian (8, 16, 8 and 8
+  // bytes). chainId is PRIVACY_CHAIN_ID, the nonce is Nonces(owner) and
+  // deadline is compared with platon_timestamp().
+  ACTION bool Permit(const Address &owner, const Address &spender, u128 value,
+                     uint64_t deadline, const bytes &signature) {
+    privacy_assert(value > 0, "PlatON ARC20: approve amount illegal");
+    privacy_assert(uint64_t(platon_timestamp()) <= deadline,
+                   "PlatON ARC20: permit expired");
+    uint64_t nonce = GetNonce(owner);
+    h256 digest = PermitDigest(owner, spender, value, nonce, deadline);
+    Address signer;
+    privacy_assert(
+        platon_ecrecover(digest, signature, signer) == 0 && signer == owner,
+        "PlatON ARC20: invalid permit signature");
+
+    SetNonce(owner, nonce + 1);
+    SetAllowance(owner, spender, value);
+    PLATON_EMIT_EVENT2(ApprovalEvent, owner, spender, value);
+    TRACE_ACTION("permit", "owner:", owner.toString(),
+                 "spender:", spender.toString(), "value:", value,
+                 "nonce:", nonce);
     return true;
   }
 
+  CONST uint64_t Nonces(const Address &owner) { return GetNonce(owner); }
+
   ACTION bool IncreaseApprove(const Address &spender, u128 value) {
     Address sender = platon_caller();
     u128 old_val = GetAllowance(sender, spender);
@@ -145,9 +224,9 @@ CONTRACT ARC20 : public Contract {
     SetAllowance(sender, spender, new_val);
 
     PLATON_EMIT_EVENT2(ApprovalEvent, sender, spender, new_val);
-    DEBUG("increase approve", "sender:", sender.toString(),
-          "spender:", spender.toString(), "oldVal:", old_val, "value:", value,
-          "new_val:", new_val);
+    TRACE_ACTION("increase approve", "sender:", sender.toString(), "spender:",
+                 spender.toString(), "oldVal:", old_val, "value:", value,
+                 "new_val:", new_val);
     return true;
   }
 
@@ -161,9 +240,9 @@ CONTRACT ARC20 : public Contract {
     SetAllowance(sender, spender, new_val);
 
     PLATON_EMIT_EVENT2(ApprovalEvent, sender, spender, new_val);
-    DEBUG("decrease approve", "sender:", sender.toString(),
-          "spender:", spender.toString(), "oldVal:", old_val, "value:", value,
-          "new_val:", new_val);
+    TRACE_ACTION("decrease approve", "sender:", sender.toString(), "spender:",
+                 spender.toString(), "oldVal:", old_val, "value:", value,
+                 "new_val:", new_val);
     return true;
   }
 
@@ -179,14 +258,14 @@ CONTRACT ARC20 : public Contract {
     SetTotalSupply(total_supply + value);
     SetBalance(account, GetBalance(account) + value);
     PLATON_EMIT_EVENT1(MintEvent, account, value);
-    DEBUG("mint", "sender:", sender.toString(), "account:", account.toString(),
-          "value:", value);
+    TRACE_ACTION("mint", "sender:", sender.toString(), "account:",
+                 account.toString(), "value:", value);
     return true;
   }
 
   ACTION bool Burn(const Address &account, u128 value) {
-    DEBUG("burn", "sender:", platon_caller().toString(),
-          "account:", account.toString(), "value:", value);
+    TRACE_ACTION("burn", "sender:", platon_caller().toString(), "account:",
+                 account.toString(), "value:", value);
     privacy_assert(GetOwner() == platon_caller(),
                    "PlatON ARC20: only owner can do burn");
     privacy_assert(account != Address(0),
@@ -261,7 +340,7 @@ CONTRACT ARC20 : public Contract {
     platon_get_state(owner.data(), owner.size, (byte *)&balance,
                      sizeof(balance));
 
-    DEBUG("balance", "owner:", owner.toString(), "balance:", balance);
+    TRACE_STATE("balance", "owner:", owner.toString(), "balance:", balance);
     return balance;
   }
 
@@ -269,7 +348,7 @@ CONTRACT ARC20 : public Contract {
     platon_set_state(owner.data(), owner.size, (const byte *)&balance,
                      sizeof(balance));
 
-    DEBUG("set balance", "owner:", owner.toString(), "balance:", balance);
+    TRACE_STATE("set balance", "owner:", owner.toString(), "balance:", balance);
     return balance;
   }
 
@@ -281,8 +360,8 @@ CONTRACT ARC20 : public Contract {
     platon_get_state(combine_addr.data(), combine_addr.size, (byte *)&balance,
                      sizeof(balance));
 
-    DEBUG("allowance", "owner:", owner.toString(),
-          "spender:", spender.toString(), "balance:", balance);
+    TRACE_STATE("allowance", "owner:", owner.toString(), "spender:",
+                spender.toString(), "balance:", balance);
     return balance;
   }
 
@@ -293,8 +372,53 @@ CONTRACT ARC20 : public Contract {
     platon_set_state(combine_addr.data(), combine_addr.size,
                      (const byte *)&value, sizeof(value));
 
-    DEBUG("set allowance", "owner:", owner.toString(),
-          "spender:", spender.toString(), "balance:", value);
+    TRACE_STATE("set allowance", "owner:", owner.toString(), "spender:",
+                spender.toString(), "balance:", value);
+  }
+
+  // nonce key: kNonce followed by the owner, 28 bytes, so it can not clash
+  // with balance (20 bytes) or allowance (40 bytes) keys
+  FixedHash<28> NonceKey(const Address &owner) {
+    FixedHash<28> key;
+    memcpy(key.data(), &kNonce, sizeof(kNonce));
+    memcpy(key.data() + sizeof(kNonce), owner.data(), owner.size);
+    return key;
+  }
+
+  uint64_t GetNonce(const Address &owner) {
+    FixedHash<28> key = NonceKey(owner);
+    uint64_t nonce = 0;
+    platon_get_state(key.data(), key.size, (byte *)&nonce, sizeof(nonce));
+    TRACE_STATE("nonce", "owner:", owner.toString(), "nonce:", nonce);
+    return nonce;
+  }
+
+  void SetNonce(const Address &owner, uint64_t nonce) {
+    FixedHash<28> key = NonceKey(owner);
+    platon_set_state(key.data(), key.size, (const byte *)&nonce,
+                     sizeof(nonce));
+    TRACE_STATE("set nonce", "owner:", owner.toString(), "nonce:", nonce);
+  }
+
+  h256 PermitDigest(const Address &owner, const Address &spender, u128 value,
+                    uint64_t nonce, uint64_t deadline) {
+    static const char kTag[] = "permit";
+    uint64_t chain_id = PRIVACY_CHAIN_ID;
+    Address token = platon_address();
+    bytes data;
+    data.insert(data.end(), kTag, kTag + sizeof(kTag) - 1);
+    data.insert(data.end(), (const byte *)&chain_id,
+                (const byte *)&chain_id + sizeof(chain_id));
+    data.insert(data.end(), token.data(), token.data() + token.size);
+    data.insert(data.end(), owner.data(), owner.data() + owner.size);
+    data.insert(data.end(), spender.data(), spender.data() + spender.size);
+    data.insert(data.end(), (const byte *)&value,
+                (const byte *)&value + sizeof(value));
+    data.insert(data.end(), (const byte *)&nonce,
+                (const byte *)&nonce + sizeof(nonce));
+    data.insert(data.end(), (const byte *)&deadline,
+                (const byte *)&deadline + sizeof(deadline));
+    return platon_sha3(data);
   }
 
   u128 TotalSupply() {
@@ -305,7 +429,7 @@ CONTRACT ARC20 : public Contract {
     ::platon_get_state((const uint8_t *)&kTotalSupply, sizeof(kTotalSupply),
                        (byte *)&supply, sizeof(supply));
 
-    DEBUG("total supply:", supply);
+    TRACE_STATE("total supply", "supply:", supply);
     return supply;
   }
 
@@ -315,11 +439,13 @@ CONTRACT ARC20 : public Contract {
   const uint64_t kTotalSupply = uint64_t(Name::Raw("total_supply"_n));
   const uint64_t kDecimals = uint64_t(Name::Raw("decimals"_n));
   const uint64_t kOwner = uint64_t(Name::Raw("owner"_n));
+  const uint64_t kNonce = uint64_t(Name::Raw("nonce"_n));
 
  private:
 };
 
 PLATON_DISPATCH(ARC20,
                 (init)(GetName)(GetSymbol)(GetTotalSupply)(GetDecimals)(
-                    BalanceOf)(Allowance)(Transfer)(TransferFrom)(Approve)(
-                    IncreaseApprove)(DecreaseApprove)(Mint)(Burn))
+                    BalanceOf)(Allowance)(Transfer)(BatchTransfer)(
+                    TransferFrom)(Approve)(Permit)(Nonces)(IncreaseApprove)(
+                    DecreaseApprove)(Mint)(Burn))
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstdint>
+
+#include "field.hpp"
+
+namespace privacy {
+
+// BN254 base field and the compressed point encodings used for proofs.
+//
+//   G1: 32 bytes, x big endian.
+//   G2: 64 bytes, x.c1 then x.c0, each 32 bytes big endian.
+//
+// The modulus is below 2^254, which leaves the top two bits of the first
+// byte for flags: 0x80 marks the lexicographically larger y (for G2, c1
+// decides unless it is zero), 0x40 marks the point at infinity, in which
+// case every other bit must be zero. Like field.hpp this has no platon
+// dependency.
+
+struct FqParams {
+  static constexpr Limbs kModulus = {0x3c208c16d87cfd47ull, 0x97816a916871ca8dull,
+                                     0xb85045b68181585dull, 0x30644e72e131a029ull};
+};
+
+using Fq = Fp<FqParams>;
+
+constexpr uint8_t kSignFlag = 0x80;
+constexpr uint8_t kInfinityFlag = 0x40;
+constexpr uint8_t kFlagMask = kSignFlag | kInfinityFlag;
+
+namespace detail {
+
+// (m + 1) / 4 and (m - 3) / 4, (m - 1) / 2 for the square roots.
+inline Limbs ShiftRight(Limbs v, unsigned n) {
+  for (unsigned k = 0; k < n; k++) {
+    for (size_t i = 0; i < 3; i++) v[i] = (v[i] >> 1) | (v[i + 1] << 63);
+    v[3] >>= 1;
+  }
+  return v;
+}
+
+inline Limbs AddSmall(Limbs v, uint64_t x) {
+  for (size_t i = 0; i < 4 && x != 0; i++) {
+    v[i] += x;
+    x = v[i] < x ? 1 : 0;
+  }
+  return v;
+}
+
+}  // namespace detail
+
+// q = 3 mod 4, so sqrt(a) = a^((q+1)/4) when a is a square.
+inline bool Sqrt(const Fq &a, Fq *root) {
+  static const Limbs kExp = detail::ShiftRight(detail::AddSmall(Fq::kModulus, 1), 2);
+  Fq r = a.Pow(kExp);
+  if (r.Square() != a) return false;
+  *root = r;
+  return true;
+}
+
+// Fq[u] / (u^2 + 1)
+struct Fq2 {
+  Fq c0, c1;
+
+  bool IsZero() const { return c0.IsZero() && c1.IsZero(); }
+  bool operator==(const Fq2 &o) const { return c0 == o.c0 && c1 == o.c1; }
+  bool operator!=(const Fq2 &o) const { return !(*this == o); }
+
+  Fq2 operator+(const Fq2 &o) const { return Fq2{c0 + o.c0, c1 + o.c1}; }
+  Fq2 operator-(const Fq2 &o) const { return Fq2{c0 - o.c0, c1 - o.c1}; }
+  Fq2 operator-() const { return Fq2{-c0, -c1}; }
+
+  Fq2 operator*(const Fq2 &o) const {
+    Fq v0 = c0 * o.c0, v1 = c1 * o.c1;
+    return Fq2{v0 - v1, (c0 + c1) * (o.c0 + o.c1) - v0 - v1};
+  }
+
+  Fq2 Square() const { return *this * *this; }
+  Fq2 Conjugate() const { return Fq2{c0, -c1}; }
+
+  Fq2 Inverse() const {
+    Fq t = (c0.Square() + c1.Square()).Inverse();
+    return Fq2{c0 * t, -(c1 * t)};
+  }
+
+  Fq2 Pow(const Limbs &e) const {
+    Fq2 r{Fq::One(), Fq()};
+    for (int i = 3; i >= 0; i--) {
+      for (int j = 63; j >= 0; j--) {
+        r = r.Square();
+        if ((e[i] >> j) & 1) r = r * *this;
+      }
+    }
+    return r;
+  }
+
+  bool IsLexLargest() const { return c1.IsZero() ? c0.IsLexLargest() : c1.IsLexLargest(); }
+};
+
+// Algorithm 9 of Adj and Rodriguez-Henriquez, "Square root computation over
+// even extension fields", for q = 3 mod 4.
+inline bool Sqrt(const Fq2 &a, Fq2 *root) {
+  static const Limbs kExp34 = detail::ShiftRight(Fq::kModulus, 2);      // (q - 3) / 4
+  static const Limbs kExp12 = detail::ShiftRight(Fq::kModulus, 1);      // (q - 1) / 2
+  const Fq2 one{Fq::One(), Fq()};
+  const Fq2 minus_one = -one;
+
+  Fq2 a1 = a.Pow(kExp34);
+  Fq2 alpha = a1.Square() * a;
+  Fq2 x0 = a1 * a;
+  Fq2 r;
+  if (alpha == minus_one) {
+    r = Fq2{-x0.c1, x0.c0};  // u * x0
+  } else {
+    r = (alpha + one).Pow(kExp12) * x0;
+  }
+  if (r.Square() != a) return false;
+  *root = r;
+  return true;
+}
+
+struct G1Affine {
+  Fq x, y;
+  bool infinity = false;
+};
+
+struct G2Affine {
+  Fq2 x, y;
+  bool infinity = false;
+};
+
+inline Fq G1B() { return Fq::FromUint64(3); }
+
+// b' = 3 / (9 + u) of the sextic twist.
+inline Fq2 G2B() {
+  static const Fq2 b = Fq2{Fq::FromUint64(3), Fq()} * Fq2{Fq::FromUint64(9), Fq::One()}.Inverse();
+  return b;
+}
+
+inline bool OnCurve(const G1Affine &p) {
+  return p.infinity || p.y.Square() == p.x.Square() * p.x + G1B();
+}
+
+inline bool OnCurve(const G2Affine &p) {
+  return p.infinity || p.y.Square() == p.x.Square() * p.x + G2B();
+}
+
+namespace detail {
+
+inline bool ReadFq(const uint8_t *be, uint8_t mask, Fq *out) {
+  uint8_t bytes[32];
+  for (size_t i = 0; i < 32; i++) bytes[i] = be[i];
+  bytes[0] &= uint8_t(~mask);
+  return Fq::FromBytes(bytes, out);
+}
+
+inline bool AllZero(const uint8_t *p, size_t n, uint8_t first_mask) {
+  if ((p[0] & uint8_t(~first_mask)) != 0) return false;
+  for (size_t i = 1; i < n; i++) {
+    if (p[i] != 0) return false;
+  }
+  return true;
+}
+
+// Jacobian G2 arithmetic for the subgroup check.
+struct G2Jacobian {
+  Fq2 x, y, z;
+  bool IsInfinity() const { return z.IsZero(); }
+};
+
+inline G2Jacobian Double(const G2Jacobian &p) {
+  if (p.IsInfinity() || p.y.IsZero()) return G2Jacobian{Fq2{}, Fq2{}, Fq2{}};
+  Fq2 a = p.x.Square(), b = p.y.Square(), c = b.Square();
+  Fq2 d = (p.x + b).Square() - a - c;
+  d = d + d;
+  Fq2 e = a + a + a;
+  Fq2 x3 = e.Square() - d - d;
+  Fq2 c8 = c + c;
+  c8 = c8 + c8;
+  c8 = c8 + c8;
+  Fq2 y3 = e * (d - x3) - c8;
+  Fq2 z3 = p.y * p.z;
+  return G2Jacobian{x3, y3, z3 + z3};
+}
+
+// p + q with q affine
+inline G2Jacobian AddAffine(const G2Jacobian &p, const G2Affine &q) {
+  if (p.IsInfinity()) return G2Jacobian{q.x, q.y, Fq2{Fq::One(), Fq()}};
+  Fq2 z1z1 = p.z.Square();
+  Fq2 u2 = q.x * z1z1;
+  Fq2 s2 = q.y * p.z * z1z1;
+  Fq2 h = u2 - p.x;
+  Fq2 r = s2 - p.y;
+  if (h.IsZero()) {
+    if (r.IsZero()) return Double(p);
+    return G2Jacobian{Fq2{}, Fq2{}, Fq2{}};
+  }
+  r = r + r;
+  Fq2 hh = h.Square();
+  Fq2 i = hh + hh;
+  i = i + i;
+  Fq2 j = h * i;
+  Fq2 v = p.x * i;
+  Fq2 x3 = r.Square() - j - v - v;
+  Fq2 y1j = p.y * j;
+  Fq2 y3 = r * (v - x3) - y1j - y1j;
+  Fq2 z3 = (p.z + h).Square() - z1z1 - hh;
+  return G2Jacobian{x3, y3, z3};
+}
+
+}  // namespace detail
+
+// G1 has cofactor 1, so a point on the curve is in the subgroup.
+inline bool DecompressG1(const uint8_t *in, G1Affine *out) {
+  if (in[0] & kInfinityFlag) {
+    if (!detail::AllZero(in, 32, kInfinityFlag)) return false;
+    *out = G1Affine{Fq(), Fq(), true};
+    return true;
+  }
+  G1Affine p;
+  if (!detail::ReadFq(in, kFlagMask, &p.x)) return false;
+  if (!Sqrt(p.x.Square() * p.x + G1B(), &p.y)) return false;
+  if (p.y.IsLexLargest() != bool(in[0] & kSignFlag)) p.y = -p.y;
+  *out = p;
+  return true;
+}
+
+inline void CompressG1(const G1Affine &p, uint8_t *out) {
+  if (p.infinity) {
+    for (size_t i = 0; i < 32; i++) out[i] = 0;
+    out[0] = kInfinityFlag;
+    return;
+  }
+  p.x.ToBytes(out);
+  if (p.y.IsLexLargest()) out[0] |= kSignFlag;
+}
+
+// [r]P == O, r the group order.
+inline bool InSubgroup(const G2Affine &p) {
+  if (p.infinity) return true;
+  detail::G2Jacobian acc{Fq2{}, Fq2{}, Fq2{}};
+  const Limbs &r = FrParams::kModulus;
+  for (int i = 3; i >= 0; i--) {
+    for (int j = 63; j >= 0; j--) {
+      acc = detail::Double(acc);
+      if ((r[i] >> j) & 1) acc = detail::AddAffine(acc, p);
+    }
+  }
+  return acc.IsInfinity();
+}
+
+// Decompresses and checks curve and subgroup membership.
+inline bool DecompressG2(const uint8_t *in, G2Affine *out) {
+  if (in[0] & kInfinityFlag) {
+    if (!detail::AllZero(in, 64, kInfinityFlag)) return false;
+    *out = G2Affine{Fq2{}, Fq2{}, true};
+    return true;
+  }
+  G2Affine p;
+  if (!detail::ReadFq(in, kFlagMask, &p.x.c1) || !detail::ReadFq(in + 32, 0, &p.x.c0)) return false;
+  if (!Sqrt(p.x.Square() * p.x + G2B(), &p.y)) return false;
+  if (p.y.IsLexLargest() != bool(in[0] & kSignFlag)) p.y = -p.y;
+  if (!InSubgroup(p)) return false;
+  *out = p;
+  return true;
+}
+
+inline void CompressG2(const G2Affine &p, uint8_t *out) {
+  if (p.infinity) {
+    for (size_t i = 0; i < 64; i++) out[i] = 0;
+    out[0] = kInfinityFlag;
+    return;
+  }
+  p.x.c1.ToBytes(out);
+  p.x.c0.ToBytes(out + 32);
+  if (p.y.IsLexLargest()) out[0] |= kSignFlag;
+}
+
+}  // namespace privacy
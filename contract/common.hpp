@@ -16,6 +16,88 @@ class PrivacyRevert {
   }
 };
 
+// Phase profiling, compiled in with -DPRIVACY_PROFILE. A contract declares
+// PRIVACY_PROFILER as its first data member, so that it is destroyed after
+// the StorageType members have written themselves back, starts an action
+// with PRIVACY_PROFILE_ACTION and marks phases with PRIVACY_PHASE. When the
+// contract object goes away, gas and state bytes of every phase are emitted
+// in one PrivacyProfileEvent; client/tools/profile_report.cpp aggregates
+// them over a run.
+//
+// Gas is measured. State bytes are not: the chain does not report how many
+// bytes a write serializes to, so phases add their own estimate with
+// PRIVACY_STATE_BYTES_ESTIMATE, 32 bytes per node, root or nullifier
+// written, and the storage phase the size of the containers written back.
+#ifdef PRIVACY_PROFILE
+struct PhaseCost {
+  std::string phase;
+  uint64_t gas;
+  uint64_t estimatedStateBytes;
+  PLATON_SERIALIZE(PhaseCost, (phase)(gas)(estimatedStateBytes))
+};
+
+class PrivacyProfiler {
+  PLATON_EVENT1(PrivacyProfileEvent, const std::string &,
+                const std::vector<PhaseCost> &)
+ public:
+  ~PrivacyProfiler() {
+    if (action_.empty()) return;
+    Close();
+    PLATON_EMIT_EVENT1(PrivacyProfileEvent, action_, phases_);
+    Current() = nullptr;
+  }
+
+  // nested actions (mintWithPermit -> mint) are folded into the outer one
+  void Begin(const char *action) {
+    if (!action_.empty()) return;
+    action_ = action;
+    Current() = this;
+  }
+
+  void Phase(const char *name) {
+    if (action_.empty()) return;
+    Close();
+    phase_ = name;
+    bytes_ = 0;
+    gas_ = ::platon_gas();
+  }
+
+  void AddStateBytesEstimate(uint64_t bytes) { bytes_ += bytes; }
+
+  static const char *CurrentPhase() {
+    return Current() == nullptr ? "" : Current()->phase_.c_str();
+  }
+
+ private:
+  static PrivacyProfiler *&Current() {
+    static PrivacyProfiler *current = nullptr;
+    return current;
+  }
+
+  void Close() {
+    if (phase_.empty()) return;
+    phases_.push_back(PhaseCost{phase_, gas_ - ::platon_gas(), bytes_});
+    phase_.clear();
+  }
+
+  std::string action_;
+  std::string phase_;
+  uint64_t gas_ = 0;
+  uint64_t bytes_ = 0;
+  std::vector<PhaseCost> phases_;
+};
+
+#define PRIVACY_PROFILER PrivacyProfiler privacyProfiler;
+#define PRIVACY_PROFILE_ACTION(name) privacyProfiler.Begin(name)
+#define PRIVACY_PHASE(name) privacyProfiler.Phase(name)
+#define PRIVACY_STATE_BYTES_ESTIMATE(bytes) privacyProfiler.AddStateBytesEstimate(bytes)
+#else
+#define PRIVACY_PROFILER
+#define PRIVACY_PROFILE_ACTION(name) ((void)0)
+#define PRIVACY_PHASE(name) ((void)0)
+#define PRIVACY_STATE_BYTES_ESTIMATE(bytes) ((void)0)
+#endif
+
 #define privacy_assert(A, ...)                                       \
   privacy_assert_aux(A, #A, __LINE__, __FILE__, __func__, \
                                 ##__VA_ARGS__)
@@ -29,11 +111,36 @@ inline void privacy_assert_aux(bool cond, const char *cond_str, unsigned line,
     platon::print(all_info, std::forward<Args>(args)...);
     platon::println("Assertion failed:", cond_str, "func:", func, "line:", line,
             "file:", file, all_info);
+#ifdef PRIVACY_PROFILE
+    platon::println("Assertion failed in phase:", PrivacyProfiler::CurrentPhase());
+#endif
     PrivacyRevert::Revert(all_info);
     ::platon_revert();
   }
 }
 
+// Tracing, compiled in by level so release builds neither print nor
+// evaluate the arguments (Address::toString() and friends):
+//   PRIVACY_TRACE_LEVEL 0  nothing (default)
+//   PRIVACY_TRACE_LEVEL 1  one line per action
+//   PRIVACY_TRACE_LEVEL 2  also every state read and write
+// Arguments are the event name followed by "key:", value pairs.
+#ifndef PRIVACY_TRACE_LEVEL
+#define PRIVACY_TRACE_LEVEL 0
+#endif
+
+#if PRIVACY_TRACE_LEVEL >= 1
+#define TRACE_ACTION(name, ...) platon::println("trace action", name, ##__VA_ARGS__)
+#else
+#define TRACE_ACTION(...) ((void)0)
+#endif
+
+#if PRIVACY_TRACE_LEVEL >= 2
+#define TRACE_STATE(name, ...) platon::println("trace state", name, ##__VA_ARGS__)
+#else
+#define TRACE_STATE(...) ((void)0)
+#endif
+
 namespace platon {
 namespace crypto {
 namespace bn256 {
@@ -51,6 +158,177 @@ struct Proof {
 }  // namespace crypto
 }  // namespace platon
 
+// Amounts are field elements in the public inputs but u128 in ARC20 and for
+// the native coin; reverts when the value does not fit.
+inline platon::u128 ToU128(const std::uint256_t &value) {
+  platon::bytes be;
+  value.ToBigEndian(be);
+  platon::u128 result = 0;
+  for (size_t i = 0; i < be.size(); i++) {
+    privacy_assert(i + 16 >= be.size() || be[i] == 0, "amount exceeds u128");
+    result = (result << 8) | be[i];
+  }
+  return result;
+}
+
+// Addresses the privacy contracts keep in raw state, set by init.
+constexpr uint64_t kOwnerKey = platon::name_value("owner");
+constexpr uint64_t kVerifyKey = platon::name_value("verify");
+constexpr uint64_t kArc20Key = platon::name_value("arc20");
+
+inline platon::Address GetAddress(uint64_t key) {
+  platon::Address addr;
+  ::platon_get_state((const platon::byte *)&key, sizeof(key), addr.data(), addr.size);
+  return addr;
+}
+
+inline void SetAddress(uint64_t key, const platon::Address &addr) {
+  ::platon_set_state((const platon::byte *)&key, sizeof(key), addr.data(), addr.size);
+}
+
+// Checks a proof with the Verify contract, reverts with `error`.
+inline void VerifyProof(const platon::Address &verify, const std::vector<std::uint256_t> &inputs,
+                        const platon::crypto::bn256::g16::Proof &proof, uint8_t type, const char *error) {
+  auto res = platon::platon_call_with_return_value<bool>(verify, platon::u128(0), ::platon_gas(),
+                                                         "VerifyTx", inputs, proof, type);
+  privacy_assert(res.second && res.first, error);
+}
+
+// Every action but a native-coin mint is non-payable; a call value sent
+// with one would stay locked in the contract.
+inline void CheckNoCallValue() {
+  privacy_assert(platon::platon_call_value() == 0, "action does not accept native coin");
+}
+
+// Moves a minted amount into the pool: the call value for the native coin
+// (zero arc20), otherwise an ARC20 TransferFrom of the caller's approval.
+inline void PayIn(const platon::Address &arc20, const std::uint256_t &amount) {
+  if (arc20 == platon::Address(0)) {
+    privacy_assert(platon::platon_call_value() == ToU128(amount), "call value does not match the mint amount");
+    return;
+  }
+
+  privacy_assert(platon::platon_call_value() == 0, "ARC20 pool does not accept native coin");
+  auto res = platon::platon_call_with_return_value<bool>(arc20, platon::u128(0), ::platon_gas(), "TransferFrom",
+                                                         platon::platon_caller(), platon::platon_address(),
+                                                         ToU128(amount));
+  privacy_assert(res.second && res.first,
+                 "Failed to call the transferFrom method of the ARC20 contract across contracts");
+}
+
+// Pays a burned amount out of the pool, natively for a zero arc20.
+inline void PayOut(const platon::Address &arc20, const platon::Address &payTo, const std::uint256_t &value) {
+  if (arc20 == platon::Address(0)) {
+    privacy_assert(platon::platon_transfer(payTo, platon::Energon(ToU128(value))), "native coin transfer failed");
+    return;
+  }
+
+  auto res = platon::platon_call_with_return_value<bool>(arc20, platon::u128(0), ::platon_gas(), "Transfer",
+                                                         payTo, ToU128(value));
+  privacy_assert(res.second && res.first, "Failed to call the Transfer method of the ARC20 contract across contracts");
+}
+
+// Snapshot of the commitment tree a client can resume from: the leaf
+// count, the root and, for every level, the left sibling the next append
+// hashes against (zero where the next leaf's ancestor is a left child).
+struct Checkpoint {
+    uint64_t count;
+    std::uint256_t root;
+    std::vector<std::uint256_t> frontier;
+    PLATON_SERIALIZE(Checkpoint, (count)(root)(frontier))
+};
+
+// Merkle paths for a batch of leaves. Siblings shared between the paths
+// are sent once, keyed by heap index; nodes absent from the list are zero.
+struct MerklePaths {
+    std::uint256_t root;
+    std::vector<uint64_t> indexes;
+    std::vector<std::uint256_t> nodes;
+    PLATON_SERIALIZE(MerklePaths, (root)(indexes)(nodes))
+};
+
+// Compact event payload, emitted as a single `packed` event per action
+// instead of the create/destory events:
+//
+//   0   u8  version
+//   1   u8  action (MINT, TRANSFER, BURN, BURN_PARTIAL)
+//   2   u8  number of outputs n
+//   3   u8  number of nullifiers m
+//   4   n * output record:
+//         commitment  32 bytes big endian
+//         amount      32 bytes big endian
+//         coinIndex    8 bytes little endian
+//         owner offset 2 bytes little endian, relative to the owner area
+//         owner size   2 bytes little endian
+//   .   m * nullifier, 32 bytes big endian
+//   .   owner area: owner payloads back to back
+class PackedEvent {
+ public:
+  constexpr static uint8_t kVersion = 1;
+  constexpr static size_t kHeaderSize = 4;
+  constexpr static size_t kOutputSize = 76;
+  constexpr static size_t kNullifierSize = 32;
+
+  PackedEvent(uint8_t action, uint8_t outputs, uint8_t nullifiers) {
+    data_.reserve(kHeaderSize + outputs * kOutputSize + nullifiers * kNullifierSize);
+    data_.push_back(kVersion);
+    data_.push_back(action);
+    data_.push_back(outputs);
+    data_.push_back(nullifiers);
+  }
+
+  // all outputs must be added before the first nullifier
+  void AddOutput(const std::uint256_t &commitment, const std::uint256_t &amount,
+                 uint64_t coinIndex, const platon::bytes &owner) {
+    privacy_assert(owners_.size() + owner.size() <= 0xffff, "owner payloads too large");
+    AppendUint256(commitment);
+    AppendUint256(amount);
+    AppendLittleEndian(coinIndex, 8);
+    AppendLittleEndian(owners_.size(), 2);
+    AppendLittleEndian(owner.size(), 2);
+    owners_.insert(owners_.end(), owner.begin(), owner.end());
+  }
+
+  void AddNullifier(const std::uint256_t &nullifier) { AppendUint256(nullifier); }
+
+  const platon::bytes &Finish() {
+    data_.insert(data_.end(), owners_.begin(), owners_.end());
+    owners_.clear();
+    return data_;
+  }
+
+ private:
+  void AppendUint256(const std::uint256_t &value) {
+    platon::bytes be;
+    value.ToBigEndian(be);
+    data_.insert(data_.end(), 32 - be.size(), 0);
+    data_.insert(data_.end(), be.begin(), be.end());
+  }
+
+  void AppendLittleEndian(uint64_t value, size_t size) {
+    for (size_t i = 0; i < size; i++) data_.push_back(uint8_t(value >> (8 * i)));
+  }
+
+  platon::bytes data_;
+  platon::bytes owners_;
+};
+
+// owner payload of create events: a one byte view tag derived from the
+// sender/recipient key exchange, followed by the encrypted (pk, r)
+constexpr size_t kViewTagSize = 1;
+
+inline void CheckOwnerPayload(const platon::bytes &owner) {
+  privacy_assert(owner.size() > kViewTagSize, "owner payload has no view tag");
+}
+
 constexpr uint8_t MINT = 0;
 constexpr uint8_t TRANSFER = 1;
-constexpr uint8_t BURN = 2;
\ No newline at end of file
+constexpr uint8_t BURN = 2;
+
+// PrivacyPool proofs, circuits in code/pool
+constexpr uint8_t POOL_MINT = 3;
+constexpr uint8_t POOL_TRANSFER = 4;
+constexpr uint8_t POOL_BURN = 5;
+
+// PrivacyArc20::burnPartial, circuit in code/burn-partial
+constexpr uint8_t BURN_PARTIAL = 6;
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <platon/platon.hpp>
+#include "bn254.hpp"
+#include "common.hpp"
+
+namespace platon {
+namespace crypto {
+namespace bn256 {
+namespace g16 {
+
+// Proof with a and c compressed to their x coordinate, encoded as in
+// bn254.hpp, and b in coordinate form: 192 bytes instead of 256. G1 has
+// cofactor 1, so decompressing a or c is one Fq square root and no
+// subgroup check. b stays uncompressed: an Fq2 square root and a G2
+// subgroup check cost far more gas than its 64 bytes.
+struct CompressedProof {
+  std::uint256_t a;
+  G2 b;
+  std::uint256_t c;
+  PLATON_SERIALIZE(CompressedProof, (a)(b)(c))
+};
+
+namespace compressed {
+
+inline std::uint256_t ToUint256(const privacy::Fq &value) {
+  privacy::Limbs limbs = value.ToCanonical();
+  std::uint256_t result = 0;
+  for (int i = 3; i >= 0; i--) {
+    result = (result << 64) | std::uint256_t(limbs[i]);
+  }
+  return result;
+}
+
+// Reverts when x is not the encoding of a point on the curve.
+inline G1 DecompressPoint(const std::uint256_t &x) {
+  platon::bytes be;
+  x.ToBigEndian(be);
+  uint8_t in[32] = {0};
+  memcpy(in + 32 - be.size(), be.data(), be.size());
+  privacy::G1Affine p;
+  privacy_assert(privacy::DecompressG1(in, &p), "invalid compressed proof point");
+
+  // G1{0, 0} is the point at infinity
+  if (p.infinity) return G1{0, 0};
+  return G1{ToUint256(p.x), ToUint256(p.y)};
+}
+
+}  // namespace compressed
+
+inline Proof DecompressProof(const CompressedProof &in) {
+  return Proof{compressed::DecompressPoint(in.a), in.b, compressed::DecompressPoint(in.c)};
+}
+
+}  // namespace g16
+}  // namespace bn256
+}  // namespace crypto
+}  // namespace platon
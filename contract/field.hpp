@@ -0,0 +1,289 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace privacy {
+
+using Limbs = std::array<uint64_t, 4>;
+
+namespace detail {
+
+constexpr bool GreaterOrEqual(const Limbs &a, const Limbs &b) {
+  for (int i = 3; i >= 0; i--) {
+    if (a[i] != b[i]) return a[i] > b[i];
+  }
+  return true;
+}
+
+constexpr Limbs Subtract(const Limbs &a, const Limbs &b) {
+  Limbs r{};
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < 4; i++) {
+    uint64_t t = a[i] - b[i];
+    uint64_t nb = (a[i] < b[i]) || (t < borrow);
+    r[i] = t - borrow;
+    borrow = nb;
+  }
+  return r;
+}
+
+// 2^512 mod m by repeated doubling, evaluated at compile time.
+constexpr Limbs MontgomeryR2(const Limbs &m) {
+  Limbs r{1, 0, 0, 0};
+  for (int i = 0; i < 512; i++) {
+    uint64_t carry = r[3] >> 63;
+    for (int j = 3; j > 0; j--) r[j] = (r[j] << 1) | (r[j - 1] >> 63);
+    r[0] <<= 1;
+    if (carry || GreaterOrEqual(r, m)) r = Subtract(r, m);
+  }
+  return r;
+}
+
+// -m^-1 mod 2^64 by Newton iteration.
+constexpr uint64_t MontgomeryInv(uint64_t m0) {
+  uint64_t inv = 1;
+  for (int i = 0; i < 6; i++) inv *= 2 - m0 * inv;
+  return ~inv + 1;
+}
+
+}  // namespace detail
+
+// Prime field element in Montgomery form over four 64-bit limbs. The moduli
+// used here are below 2^254, so sums never overflow the top limb.
+//
+// The class has no platon dependency and throws nothing, so the contracts
+// can share it with the host-side tools.
+template <typename Params>
+class Fp {
+ public:
+  static constexpr Limbs kModulus = Params::kModulus;
+  static constexpr Limbs kR2 = detail::MontgomeryR2(Params::kModulus);
+  static constexpr uint64_t kInv = detail::MontgomeryInv(Params::kModulus[0]);
+
+  constexpr Fp() : v_{} {}
+
+  static Fp Zero() { return Fp(); }
+  static Fp One() { return FromUint64(1); }
+
+  static Fp FromUint64(uint64_t x) { return FromCanonical(Limbs{x, 0, 0, 0}); }
+
+  // `c` must already be reduced.
+  static Fp FromCanonical(const Limbs &c) {
+    Fp r;
+    r.v_ = MulRaw(c, kR2);
+    return r;
+  }
+
+  // Reduces any 256-bit value; used for hash outputs and wide constants.
+  static Fp FromWide(Limbs c) {
+    while (detail::GreaterOrEqual(c, kModulus)) c = detail::Subtract(c, kModulus);
+    return FromCanonical(c);
+  }
+
+  // 32-byte big-endian, rejects non-canonical encodings.
+  static bool FromBytes(const uint8_t *be, Fp *out) {
+    Limbs c = BytesToLimbs(be);
+    if (detail::GreaterOrEqual(c, kModulus)) return false;
+    *out = FromCanonical(c);
+    return true;
+  }
+
+  // Accepts "0x"-prefixed hex, as found in the verification keys, and
+  // decimal, as printed by zokrates.
+  static bool FromString(const std::string &s, Fp *out) {
+    Limbs c{};
+    if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+      if (s.size() - 2 > 64) return false;
+      for (size_t i = 2; i < s.size(); i++) {
+        int d = HexDigit(s[i]);
+        if (d < 0) return false;
+        for (int j = 3; j > 0; j--) c[j] = (c[j] << 4) | (c[j - 1] >> 60);
+        c[0] = (c[0] << 4) | uint64_t(d);
+      }
+    } else {
+      if (s.empty()) return false;
+      for (char ch : s) {
+        if (ch < '0' || ch > '9') return false;
+        unsigned __int128 carry = uint64_t(ch - '0');
+        for (size_t j = 0; j < 4; j++) {
+          unsigned __int128 t = (unsigned __int128)c[j] * 10 + carry;
+          c[j] = uint64_t(t);
+          carry = t >> 64;
+        }
+        if (carry != 0) return false;
+      }
+    }
+    if (detail::GreaterOrEqual(c, kModulus)) return false;
+    *out = FromCanonical(c);
+    return true;
+  }
+
+  Limbs ToCanonical() const { return MulRaw(v_, Limbs{1, 0, 0, 0}); }
+
+  void ToBytes(uint8_t *be) const { LimbsToBytes(ToCanonical(), be); }
+
+  std::string ToHex() const {
+    static const char kDigits[] = "0123456789abcdef";
+    Limbs c = ToCanonical();
+    std::string s = "0x";
+    for (int i = 3; i >= 0; i--) {
+      for (int j = 60; j >= 0; j -= 4) s.push_back(kDigits[(c[i] >> j) & 0xf]);
+    }
+    return s;
+  }
+
+  std::string ToDecimal() const {
+    Limbs c = ToCanonical();
+    std::string s;
+    while (c[0] | c[1] | c[2] | c[3]) {
+      unsigned __int128 rem = 0;
+      for (int j = 3; j >= 0; j--) {
+        unsigned __int128 t = (rem << 64) | c[j];
+        c[j] = uint64_t(t / 10);
+        rem = t % 10;
+      }
+      s.insert(s.begin(), char('0' + int(rem)));
+    }
+    return s.empty() ? "0" : s;
+  }
+
+  // Montgomery representation, for serialization of in-memory caches.
+  const Limbs &Raw() const { return v_; }
+
+  bool IsZero() const { return (v_[0] | v_[1] | v_[2] | v_[3]) == 0; }
+
+  bool operator==(const Fp &o) const { return v_ == o.v_; }
+  bool operator!=(const Fp &o) const { return v_ != o.v_; }
+
+  Fp operator+(const Fp &o) const {
+    Fp r;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < 4; i++) {
+      unsigned __int128 t = (unsigned __int128)v_[i] + o.v_[i] + carry;
+      r.v_[i] = uint64_t(t);
+      carry = uint64_t(t >> 64);
+    }
+    if (detail::GreaterOrEqual(r.v_, kModulus)) r.v_ = detail::Subtract(r.v_, kModulus);
+    return r;
+  }
+
+  Fp operator-(const Fp &o) const {
+    Fp r;
+    if (detail::GreaterOrEqual(v_, o.v_)) {
+      r.v_ = detail::Subtract(v_, o.v_);
+    } else {
+      r.v_ = detail::Subtract(kModulus, detail::Subtract(o.v_, v_));
+    }
+    return r;
+  }
+
+  Fp operator-() const { return Fp() - *this; }
+
+  Fp operator*(const Fp &o) const {
+    Fp r;
+    r.v_ = MulRaw(v_, o.v_);
+    return r;
+  }
+
+  Fp &operator+=(const Fp &o) { return *this = *this + o; }
+  Fp &operator-=(const Fp &o) { return *this = *this - o; }
+  Fp &operator*=(const Fp &o) { return *this = *this * o; }
+
+  Fp Square() const { return *this * *this; }
+
+  // Exponent given as little-endian limbs.
+  Fp Pow(const Limbs &e) const {
+    Fp r = One();
+    for (int i = 3; i >= 0; i--) {
+      for (int j = 63; j >= 0; j--) {
+        r = r.Square();
+        if ((e[i] >> j) & 1) r *= *this;
+      }
+    }
+    return r;
+  }
+
+  Fp Inverse() const {
+    Limbs e = detail::Subtract(kModulus, Limbs{2, 0, 0, 0});
+    return Pow(e);
+  }
+
+  // Lexicographic "sign" used by the point encodings: true when the
+  // canonical value is greater than (m - 1) / 2.
+  bool IsLexLargest() const {
+    Limbs c = ToCanonical();
+    Limbs half = detail::Subtract(kModulus, Limbs{1, 0, 0, 0});
+    for (size_t i = 0; i < 3; i++) half[i] = (half[i] >> 1) | (half[i + 1] << 63);
+    half[3] >>= 1;
+    return !detail::GreaterOrEqual(half, c);
+  }
+
+  static Limbs BytesToLimbs(const uint8_t *be) {
+    Limbs c{};
+    for (size_t i = 0; i < 32; i++) {
+      c[3 - i / 8] = (c[3 - i / 8] << 8) | be[i];
+    }
+    return c;
+  }
+
+  static void LimbsToBytes(const Limbs &c, uint8_t *be) {
+    for (size_t i = 0; i < 32; i++) {
+      be[i] = uint8_t(c[3 - i / 8] >> (56 - 8 * (i % 8)));
+    }
+  }
+
+ private:
+  static int HexDigit(char ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+  }
+
+  // CIOS Montgomery multiplication.
+  static Limbs MulRaw(const Limbs &a, const Limbs &b) {
+    uint64_t t[6] = {0, 0, 0, 0, 0, 0};
+    for (size_t i = 0; i < 4; i++) {
+      unsigned __int128 carry = 0;
+      for (size_t j = 0; j < 4; j++) {
+        carry += (unsigned __int128)a[j] * b[i] + t[j];
+        t[j] = uint64_t(carry);
+        carry >>= 64;
+      }
+      carry += t[4];
+      t[4] = uint64_t(carry);
+      t[5] = uint64_t(carry >> 64);
+
+      uint64_t m = t[0] * kInv;
+      carry = (unsigned __int128)m * kModulus[0] + t[0];
+      carry >>= 64;
+      for (size_t j = 1; j < 4; j++) {
+        carry += (unsigned __int128)m * kModulus[j] + t[j];
+        t[j - 1] = uint64_t(carry);
+        carry >>= 64;
+      }
+      carry += t[4];
+      t[3] = uint64_t(carry);
+      t[4] = t[5] + uint64_t(carry >> 64);
+    }
+    Limbs r{t[0], t[1], t[2], t[3]};
+    if (t[4] != 0 || detail::GreaterOrEqual(r, kModulus)) r = detail::Subtract(r, kModulus);
+    return r;
+  }
+
+  Limbs v_;
+};
+
+// BN254 scalar field: the field the circuits, MiMC and the commitment tree
+// live in.
+struct FrParams {
+  static constexpr Limbs kModulus = {0x43e1f593f0000001ull, 0x2833e84879b97091ull,
+                                     0xb85045b68181585dull, 0x30644e72e131a029ull};
+};
+
+using Fr = Fp<FrParams>;
+
+}  // namespace privacy
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <platon/platon.hpp>
+#include "platon/hash/mimc.hpp"
+#include "common.hpp"
+
+// Append-only MiMC commitment tree shared by the privacy contracts. Nodes
+// are kept in heap order (root 0, leaf n at kWidth - 1 + n, which is the
+// coinIndex of create events) and nodes that were never written are zero.
+// The state lives in StorageType members, so it is loaded with the contract
+// and written back when the contract object is destroyed.
+//
+// In epoch mode Append only buffers the leaf. The leaves of a block are
+// hashed into the tree, one pass per level, and the root is added to the
+// history once: by the first action of a later block (OnBlock) or by an
+// explicit Finalize. Leaves keep the coinIndex they were appended at and
+// proofs can use any finalized root; the queries below only cover the
+// finalized leaves.
+class CommitmentTree {
+ public:
+  constexpr static uint64_t kWidth = 4294967296ul;  // 2^32
+  constexpr static uint32_t kDepth = 33;
+
+  // leaves including the pending ones, the next leaf's position
+  uint64_t Count() { return count_.self(); }
+
+  uint64_t FinalizedCount() { return count_.self() - pending_.self().size(); }
+
+  bool EpochMode() { return epoch_.self(); }
+
+  void SetEpochMode(bool epoch) {
+    if (!epoch) Finalize();
+    epoch_.self() = epoch;
+  }
+
+  // called by every action that touches the tree, finalizes the leaves of
+  // an earlier block
+  void OnBlock(uint64_t block) {
+    if (!epoch_.self() || pendingBlock_.self() == block) return;
+    Finalize();
+    pendingBlock_.self() = block;
+  }
+
+  // hashes the pending leaves into the tree and saves the root
+  void Finalize() {
+    std::vector<std::uint256_t> &pending = pending_.self();
+    if (pending.empty()) return;
+    uint64_t first = kWidth - 1 + FinalizedCount();
+    for (size_t i = 0; i < pending.size(); i++) {
+      nodes_.self()[first + i] = pending[i];
+    }
+    UpdateRange(first, first + pending.size() - 1);
+    pending.clear();
+    roots_.self().insert(NodeAt(0));
+  }
+
+  std::uint256_t Root() { return NodeAt(0); }
+
+  bool KnownRoot(const std::uint256_t &root) {
+    return roots_.self().count(root) != 0;
+  }
+
+  // appends a leaf and updates its path, or buffers it in epoch mode;
+  // returns the leaf's heap index
+  uint64_t Append(const std::uint256_t &commitment) {
+    uint64_t leafIndex = kWidth - 1 + count_.self()++;
+    if (epoch_.self()) {
+      pending_.self().push_back(commitment);
+      return leafIndex;
+    }
+    nodes_.self()[leafIndex] = commitment;
+    UpdateRange(leafIndex, leafIndex);
+    return leafIndex;
+  }
+
+  // adds the current root to the root history, once per action; in epoch
+  // mode Finalize does this
+  void SaveRoot() {
+    if (epoch_.self()) return;
+    roots_.self().insert(NodeAt(0));
+  }
+
+  // snapshot for client bootstrap, see Checkpoint
+  Checkpoint GetCheckpoint() {
+    Checkpoint checkpoint;
+    checkpoint.count = FinalizedCount();
+    checkpoint.root = NodeAt(0);
+    checkpoint.frontier.resize(kDepth - 1);
+    for (uint32_t level = 0; level < kDepth - 1; level++) {
+      uint64_t position = checkpoint.count >> level;
+      if (position % 2 == 1) {
+        checkpoint.frontier[level] = NodeAt(LevelStart(level) + position - 1);
+      }
+    }
+    return checkpoint;
+  }
+
+  // merkle paths of several leaves, coinIndex as emitted by create
+  MerklePaths GetPaths(const std::vector<uint64_t> &coinIndexes) {
+    uint64_t end = kWidth - 1 + FinalizedCount();
+    std::set<uint64_t> siblings;
+    for (uint64_t p : coinIndexes) {
+      privacy_assert(p >= kWidth - 1 && p < end, "unknown coin index");
+      for (; p > 0; p = (p - 1) / 2) {
+        siblings.insert(p % 2 == 0 ? p - 1 : p + 1);
+      }
+    }
+
+    MerklePaths paths;
+    paths.root = NodeAt(0);
+    for (uint64_t index : siblings) {
+      std::uint256_t node = NodeAt(index);
+      if (node != 0) {
+        paths.indexes.push_back(index);
+        paths.nodes.push_back(node);
+      }
+    }
+    return paths;
+  }
+
+  // read a node without inserting it into the map
+  std::uint256_t NodeAt(uint64_t index) {
+    auto iter = nodes_.self().find(index);
+    return iter == nodes_.self().end() ? std::uint256_t(0) : iter->second;
+  }
+
+  // serialized size of the members if all are written back, 8 + 32 bytes
+  // per node and 32 per root or pending leaf; for the profile's storage
+  // phase, see PRIVACY_STATE_BYTES_ESTIMATE
+  uint64_t StorageBytesEstimate() {
+    return 40 * nodes_.self().size() + 32 * (roots_.self().size() + pending_.self().size()) + 17;
+  }
+
+  // heap index of the first node on a level, leaves are level 0
+  static uint64_t LevelStart(uint32_t level) { return (kWidth >> level) - 1; }
+
+ private:
+  // rehashes the ancestors of the leaves first..last (heap indices), each
+  // parent once per level
+  void UpdateRange(uint64_t first, uint64_t last) {
+    for (uint32_t level = 0; level < kDepth - 1; level++) {
+      first = (first - 1) / 2;
+      last = (last - 1) / 2;
+      for (uint64_t t = first; t <= last; t++) {
+        std::vector<std::uint256_t> data{NodeAt(2 * t + 1), NodeAt(2 * t + 2)};
+        nodes_.self()[t] = platon::hash::mimc::Mimc::Hash(data, 0);
+      }
+    }
+  }
+
+  platon::StorageType<"count"_n, uint64_t> count_;  // number of leaves
+  platon::StorageType<"merkleNodes"_n, std::map<uint64_t, std::uint256_t>> nodes_;
+  platon::StorageType<"roots"_n, std::set<std::uint256_t>> roots_;  // root history
+  platon::StorageType<"epoch"_n, bool> epoch_;
+  platon::StorageType<"pending"_n, std::vector<std::uint256_t>> pending_;  // leaves of pendingBlock_
+  platon::StorageType<"epochBlock"_n, uint64_t> pendingBlock_;
+};
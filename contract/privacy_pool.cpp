@@ -0,0 +1,275 @@
+#include "platon/platon.hpp"
+#include "platon/crypto/bn256/bn256.hpp"
+#include "common.hpp"
+#include "merkle_tree.hpp"
+
+using namespace platon::crypto::bn256::g16;
+
+// One privacy pool for several assets. Notes bind a token id into the
+// commitment, H(tokenId|amount|publicKey|random), so all tokens share the
+// commitment tree, the root history and the nullifier set. Token 0 is the
+// native coin, other ids are assigned by registerToken. Mint and burn
+// publish the token id, a transfer proves that its inputs and outputs hold
+// the same token without revealing which one (circuits in code/pool).
+CONTRACT PrivacyPool : public platon::Contract
+{
+private:
+    // first member, so a profile covers the storage write-back below
+    PRIVACY_PROFILER
+
+public:
+    // commitment, amount, coinIndex, owner
+    PLATON_EVENT2(create, const std::uint256_t&, std::uint256_t, uint64_t, const platon::bytes&)
+
+    // nullifier
+    PLATON_EVENT1(destory, const std::uint256_t&)
+
+    // tokenId, arc20
+    PLATON_EVENT1(token, const std::uint256_t&, const platon::Address&)
+
+    // tokenId, commitment of a minted note, next to its create event; the
+    // token of transfer outputs is only in their owner payload
+    PLATON_EVENT1(deposit, const std::uint256_t&, const std::uint256_t&)
+
+public:
+    ACTION void init(const platon::Address &verify)
+    {
+        SetAddress(kOwnerKey, platon::platon_caller());
+        SetAddress(kVerifyKey, verify);
+    }
+
+    // add an ARC20 token to the pool, its id is the next free one
+    ACTION std::uint256_t registerToken(const platon::Address &arc20)
+    {
+        CheckNoCallValue();
+        privacy_assert(platon::platon_caller() == GetAddress(kOwnerKey), "only owner can register tokens");
+        privacy_assert(arc20 != platon::Address(0), "zero address is the native coin");
+        for (const auto &entry : tokens.self())
+        {
+            privacy_assert(entry.second != arc20, "token already registered");
+        }
+
+        std::uint256_t tokenId = std::uint256_t(tokens.self().size() + 1);
+        tokens.self()[tokenId] = arc20;
+        PLATON_EMIT_EVENT1(token, tokenId, arc20);
+        return tokenId;
+    }
+
+    // epoch mode: the leaves of a block are hashed and their root saved
+    // once, by the first action of a later block or by commitRoot; proofs
+    // must use a finalized root, see CommitmentTree
+    ACTION void setEpochMode(bool epoch)
+    {
+        CheckNoCallValue();
+        privacy_assert(platon::platon_caller() == GetAddress(kOwnerKey), "only owner can set the epoch mode");
+        tree.SetEpochMode(epoch);
+    }
+
+    // finalize the pending leaves now instead of in the next block
+    ACTION void commitRoot()
+    {
+        CheckNoCallValue();
+        tree.Finalize();
+    }
+
+    // mint, inputs: tokenId, amount, commitment, then as for every circuit
+    // here the circuit's output
+    ACTION void mint(const std::vector<std::uint256_t> &inputs, const Proof &proof, const platon::bytes &owner)
+    {
+        PRIVACY_PROFILE_ACTION("mint");
+        privacy_assert(inputs.size() == 4, "mint expects tokenId, amount, commitment and output");
+        privacy_assert(inputs.back() == 1, "mint circuit output is false");
+        CheckOwnerPayload(owner);
+        platon::Address arc20 = GetToken(inputs[0]);
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, POOL_MINT, "mint operation zk verification failed");
+        PRIVACY_PHASE("finalize");
+        tree.OnBlock(platon::platon_block_number());
+
+        // public input information
+        std::uint256_t tokenId = inputs[0];
+        std::uint256_t amount = inputs[1];
+        std::uint256_t commitment = inputs[2];
+
+        // update merkle tree
+        PRIVACY_PHASE("tree");
+        uint64_t leafIndex = tree.Append(commitment);
+        tree.SaveRoot();
+        PRIVACY_STATE_BYTES_ESTIMATE(32 * (CommitmentTree::kDepth + 1));
+
+        // transfer
+        PRIVACY_PHASE("arc20");
+        PayIn(arc20, amount);
+        TRACE_ACTION("mint", "leaf:", leafIndex, "count:", tree.Count());
+
+        // event
+        PRIVACY_PHASE("event");
+        PLATON_EMIT_EVENT2(create, commitment, amount, leafIndex, owner);
+        PLATON_EMIT_EVENT1(deposit, tokenId, commitment);
+    }
+
+    // transfer, inputs: nullifierA, nullifierB, commitmentC, amountC,
+    // commitmentD, amountD, root, output
+    ACTION void transfer(const std::vector<std::uint256_t> &inputs, const Proof &proof,
+        const std::vector<platon::bytes> &owner)
+    {
+        PRIVACY_PROFILE_ACTION("transfer");
+        CheckNoCallValue();
+        privacy_assert(inputs.size() == 8, "transfer expects 8 public inputs");
+        privacy_assert(inputs.back() == 1, "transfer circuit output is false");
+        privacy_assert(owner.size() == 2, "two owner payloads expected");
+        CheckOwnerPayload(owner[0]);
+        CheckOwnerPayload(owner[1]);
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, POOL_TRANSFER, "transfer operation zk verification failed");
+        PRIVACY_PHASE("finalize");
+        tree.OnBlock(platon::platon_block_number());
+
+        // public input information
+        std::uint256_t nc = inputs[0];
+        std::uint256_t nd = inputs[1];
+        std::uint256_t ze = inputs[2];
+        std::uint256_t zeAmount = inputs[3];
+        std::uint256_t zf = inputs[4];
+        std::uint256_t zfAmount = inputs[5];
+        std::uint256_t inputRoot = inputs[6];
+
+        // check, the amounts must not wrap around the field
+        PRIVACY_PHASE("load");
+        privacy_assert(tree.KnownRoot(inputRoot), "invalid merkle tree root");
+        privacy_assert(nc != nd, "Repeated input");
+        privacy_assert(ze != zf, "Repeated output");
+        privacy_assert(nullifiers.self().end() == nullifiers.self().find(nc), "It has been spent");
+        privacy_assert(nullifiers.self().end() == nullifiers.self().find(nd), "It has been spent");
+        ToU128(zeAmount);
+        ToU128(zfAmount);
+
+        // update merkle tree and nullifiers
+        PRIVACY_PHASE("tree");
+        nullifiers.self().insert(nc);
+        nullifiers.self().insert(nd);
+        tree.Append(ze);
+        uint64_t leafIndex = tree.Append(zf);
+        tree.SaveRoot();
+        PRIVACY_STATE_BYTES_ESTIMATE(32 * (2 * CommitmentTree::kDepth + 3));
+        TRACE_ACTION("transfer", "leaves:", leafIndex - 1, leafIndex, "count:", tree.Count());
+
+        // event
+        PRIVACY_PHASE("event");
+        PLATON_EMIT_EVENT2(create, ze, zeAmount, leafIndex - 1, owner[0]);
+        PLATON_EMIT_EVENT2(create, zf, zfAmount, leafIndex, owner[1]);
+
+        PLATON_EMIT_EVENT1(destory, nc);
+        PLATON_EMIT_EVENT1(destory, nd);
+    }
+
+    // burn, inputs: tokenId, amount, nullifier, root, output
+    ACTION void burn(const std::vector<std::uint256_t> &inputs, const Proof &proof,
+        const platon::Address &payTo)
+    {
+        PRIVACY_PROFILE_ACTION("burn");
+        CheckNoCallValue();
+        privacy_assert(inputs.size() == 5, "burn expects tokenId, amount, nullifier, root and output");
+        privacy_assert(inputs.back() == 1, "burn circuit output is false");
+        platon::Address arc20 = GetToken(inputs[0]);
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, POOL_BURN, "burn operation zk verification failed");
+        PRIVACY_PHASE("finalize");
+        tree.OnBlock(platon::platon_block_number());
+
+        // public input information
+        std::uint256_t value = inputs[1];
+        std::uint256_t nc = inputs[2];
+        std::uint256_t inputRoot = inputs[3];
+
+        // check
+        PRIVACY_PHASE("load");
+        privacy_assert(tree.KnownRoot(inputRoot), "invalid merkle tree root");
+        privacy_assert(nullifiers.self().end() == nullifiers.self().find(nc), "It has been spent");
+
+        // update nullifiers
+        nullifiers.self().insert(nc);
+        PRIVACY_STATE_BYTES_ESTIMATE(32);
+
+        // transfer
+        PRIVACY_PHASE("arc20");
+        PayOut(arc20, payTo, value);
+        TRACE_ACTION("burn", "payTo:", payTo.toString());
+
+        // event
+        PRIVACY_PHASE("event");
+        PLATON_EMIT_EVENT1(destory, nc);
+    }
+
+    // the StorageType members write themselves back after this, which the
+    // profile reports as the "storage" phase
+    ~PrivacyPool()
+    {
+        PRIVACY_PHASE("storage");
+        PRIVACY_STATE_BYTES_ESTIMATE(tree.StorageBytesEstimate()
+            + 32 * nullifiers.self().size() + 52 * tokens.self().size());
+    }
+
+    // ARC20 address of a token id, zero for the native coin
+    CONST platon::Address getToken(const std::uint256_t &tokenId)
+    {
+        return GetToken(tokenId);
+    }
+
+    // tree snapshot for client bootstrap, see Checkpoint
+    CONST Checkpoint getCheckpoint()
+    {
+        return tree.GetCheckpoint();
+    }
+
+    // merkle paths of several leaves, coinIndex as emitted by create
+    CONST MerklePaths getPaths(const std::vector<uint64_t> &coinIndexes)
+    {
+        return tree.GetPaths(coinIndexes);
+    }
+
+    // 1 for every nullifier that has been spent
+    CONST std::vector<uint8_t> isSpent(const std::vector<std::uint256_t> &nullifierList)
+    {
+        std::vector<uint8_t> spent;
+        spent.reserve(nullifierList.size());
+        for (const std::uint256_t &nullifier : nullifierList)
+        {
+            spent.push_back(nullifiers.self().count(nullifier) != 0);
+        }
+        return spent;
+    }
+
+    // 1 for every root in the root history
+    CONST std::vector<uint8_t> checkRoots(const std::vector<std::uint256_t> &rootList)
+    {
+        std::vector<uint8_t> known;
+        known.reserve(rootList.size());
+        for (const std::uint256_t &root : rootList)
+        {
+            known.push_back(tree.KnownRoot(root));
+        }
+        return known;
+    }
+
+private:
+    // ARC20 address of a registered token, zero for the native coin
+    platon::Address GetToken(const std::uint256_t &tokenId)
+    {
+        if (tokenId == 0)
+        {
+            return platon::Address(0);
+        }
+        auto iter = tokens.self().find(tokenId);
+        privacy_assert(iter != tokens.self().end(), "unknown token id");
+        return iter->second;
+    }
+
+private:
+    CommitmentTree tree;                                                                   //count, nodes and root history
+    platon::StorageType<"nullifiers"_n, std::set<std::uint256_t>> nullifiers;              //store nullifiers
+    platon::StorageType<"tokens"_n, std::map<std::uint256_t, platon::Address>> tokens;     //tokenId -> arc20
+};
+
+PLATON_DISPATCH(PrivacyPool, (init)(registerToken)(setEpochMode)(commitRoot)(mint)(transfer)(burn)(getToken)
+    (getCheckpoint)(getPaths)(isSpent)(checkRoots))
@@ -0,0 +1,231 @@
+#include "platon/platon.hpp"
+#include "platon/crypto/bn256/bn256.hpp"
+#include "common.hpp"
+#include "sharded_tree.hpp"
+
+using namespace platon::crypto::bn256::g16;
+
+// PrivacyArc20 on a ShardedTree. The circuits are the ones of
+// PrivacyArc20: a proof's root is the root of one shard, so both inputs of
+// a transfer come from the same shard, while each output goes to the shard
+// of its commitment. Proving against a shard root tells which shard the
+// spent notes are in; the anonymity set is that shard.
+//
+// The tree, the root history and the nullifiers use one state key per
+// entry, so mints and transfers into different shards do not conflict.
+// Mint and burn still move tokens to or from this contract's ARC20
+// balance (or its native balance), which all of them write.
+CONTRACT PrivacyShardedArc20 : public platon::Contract
+{
+private:
+    // first member, so a profile covers the whole action
+    PRIVACY_PROFILER
+
+public:
+    // commitment, amount, coinIndex, owner; the shard is
+    // ShardedTree::ShardOf(commitment) and coinIndex the heap index in it
+    PLATON_EVENT2(create, const std::uint256_t&, std::uint256_t, uint64_t, const platon::bytes&)
+
+    // nullifier
+    PLATON_EVENT1(destory, const std::uint256_t&)
+
+public:
+    // a zero arc20 address deploys a pool of the native coin; shards is a
+    // power of two up to 256 and can not be changed later
+    ACTION void init(const platon::Address &verify, const platon::Address &arc20, uint32_t shards)
+    {
+        SetAddress(kOwnerKey, platon::platon_caller());
+        SetAddress(kVerifyKey, verify);
+        SetAddress(kArc20Key, arc20);
+
+        tree.SetShards(shards);
+    }
+
+    // mint
+    ACTION void mint(const std::vector<std::uint256_t> &inputs, const Proof &proof, const platon::bytes &owner)
+    {
+        PRIVACY_PROFILE_ACTION("mint");
+        CheckOwnerPayload(owner);
+
+        // verify
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, MINT, "mint operation zk verification failed");
+
+        // public input information
+        std::uint256_t amount = inputs[0];
+        std::uint256_t commitment = inputs[1];
+
+        // update the commitment's shard
+        PRIVACY_PHASE("tree");
+        uint32_t shard = tree.ShardOf(commitment);
+        uint64_t leafIndex = tree.Append(shard, commitment);
+        tree.SaveRoot(shard);
+        PRIVACY_STATE_BYTES_ESTIMATE(32 * (ShardedTree::kDepth + 1));
+
+        // transfer
+        PRIVACY_PHASE("arc20");
+        PayIn(GetAddress(kArc20Key), amount);
+        TRACE_ACTION("mint", "shard:", shard, "leaf:", leafIndex);
+
+        // event
+        PRIVACY_PHASE("event");
+        PLATON_EMIT_EVENT2(create, commitment, amount, leafIndex, owner);
+    }
+
+    // transfer, both inputs under the shard root inputs[6]
+    ACTION void transfer(const std::vector<std::uint256_t> &inputs, const Proof &proof,
+        const std::vector<platon::bytes> &owner)
+    {
+        PRIVACY_PROFILE_ACTION("transfer");
+        CheckNoCallValue();
+        privacy_assert(owner.size() == 2, "two owner payloads expected");
+        CheckOwnerPayload(owner[0]);
+        CheckOwnerPayload(owner[1]);
+
+        // verify
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, TRANSFER, "transfer operation zk verification failed");
+
+        // public input information
+        std::uint256_t nc = inputs[0];
+        std::uint256_t nd = inputs[1];
+        std::uint256_t ze = inputs[2];
+        std::uint256_t zeAmount = inputs[3];
+        std::uint256_t zf = inputs[4];
+        std::uint256_t zfAmount = inputs[5];
+        std::uint256_t inputRoot = inputs[6];
+
+        // check
+        PRIVACY_PHASE("load");
+        privacy_assert(tree.KnownRoot(inputRoot), "invalid merkle tree root");
+        privacy_assert(nc != nd, "Repeated input");
+        privacy_assert(ze != zf, "Repeated output");
+        privacy_assert(!tree.Spent(nc), "It has been spent");
+        privacy_assert(!tree.Spent(nd), "It has been spent");
+
+        // update the outputs' shards and nullifiers
+        PRIVACY_PHASE("tree");
+        tree.Spend(nc);
+        tree.Spend(nd);
+
+        uint32_t shardE = tree.ShardOf(ze);
+        uint32_t shardF = tree.ShardOf(zf);
+        uint64_t leafE = tree.Append(shardE, ze);
+        uint64_t leafF = tree.Append(shardF, zf);
+        tree.SaveRoot(shardE);
+        if (shardF != shardE)
+        {
+            tree.SaveRoot(shardF);
+        }
+        PRIVACY_STATE_BYTES_ESTIMATE(32 * (2 * ShardedTree::kDepth + 4));
+        TRACE_ACTION("transfer", "shards:", shardE, shardF, "leaves:", leafE, leafF);
+
+        // event
+        PRIVACY_PHASE("event");
+        PLATON_EMIT_EVENT2(create, ze, zeAmount, leafE, owner[0]);
+        PLATON_EMIT_EVENT2(create, zf, zfAmount, leafF, owner[1]);
+
+        PLATON_EMIT_EVENT1(destory, nc);
+        PLATON_EMIT_EVENT1(destory, nd);
+    }
+
+    // burn
+    ACTION void burn(const std::vector<std::uint256_t> &inputs, const Proof &proof,
+        const platon::Address &payTo)
+    {
+        PRIVACY_PROFILE_ACTION("burn");
+        CheckNoCallValue();
+
+        // verify
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, BURN, "burn operation zk verification failed");
+
+        // public input information
+        std::uint256_t value = inputs[0];
+        std::uint256_t nc = inputs[1];
+        std::uint256_t inputRoot = inputs[2];
+
+        // check
+        PRIVACY_PHASE("load");
+        privacy_assert(tree.KnownRoot(inputRoot), "invalid merkle tree root");
+        privacy_assert(!tree.Spent(nc), "It has been spent");
+
+        // update nullifiers
+        tree.Spend(nc);
+        PRIVACY_STATE_BYTES_ESTIMATE(32);
+
+        // transfer
+        PRIVACY_PHASE("arc20");
+        PayOut(GetAddress(kArc20Key), payTo, value);
+        TRACE_ACTION("burn", "payTo:", payTo.toString());
+
+        // event
+        PRIVACY_PHASE("event");
+        PLATON_EMIT_EVENT1(destory, nc);
+    }
+
+    CONST uint32_t getShards()
+    {
+        return tree.Shards();
+    }
+
+    // current root of every shard
+    CONST std::vector<std::uint256_t> getShardRoots()
+    {
+        uint32_t shards = tree.Shards();
+        std::vector<std::uint256_t> roots;
+        for (uint32_t shard = 0; shard < shards; shard++)
+        {
+            roots.push_back(tree.Root(shard));
+        }
+        return roots;
+    }
+
+    // hash of the shard roots, not stored, see ShardedTree
+    CONST std::uint256_t getRoot()
+    {
+        return tree.GlobalRoot();
+    }
+
+    // shard snapshot for client bootstrap, see Checkpoint
+    CONST Checkpoint getCheckpoint(uint32_t shard)
+    {
+        return tree.GetCheckpoint(shard);
+    }
+
+    // merkle paths of several leaves of one shard, coinIndex as emitted by create
+    CONST MerklePaths getPaths(uint32_t shard, const std::vector<uint64_t> &coinIndexes)
+    {
+        return tree.GetPaths(shard, coinIndexes);
+    }
+
+    // 1 for every nullifier that has been spent
+    CONST std::vector<uint8_t> isSpent(const std::vector<std::uint256_t> &nullifierList)
+    {
+        std::vector<uint8_t> spent;
+        spent.reserve(nullifierList.size());
+        for (const std::uint256_t &nullifier : nullifierList)
+        {
+            spent.push_back(tree.Spent(nullifier));
+        }
+        return spent;
+    }
+
+    // 1 for every root in the root history of any shard
+    CONST std::vector<uint8_t> checkRoots(const std::vector<std::uint256_t> &rootList)
+    {
+        std::vector<uint8_t> known;
+        known.reserve(rootList.size());
+        for (const std::uint256_t &root : rootList)
+        {
+            known.push_back(tree.KnownRoot(root));
+        }
+        return known;
+    }
+
+private:
+    ShardedTree tree;                                                                      //shard counts, nodes, roots and nullifiers
+};
+
+PLATON_DISPATCH(PrivacyShardedArc20, (init)(mint)(transfer)(burn)(getShards)(getShardRoots)(getRoot)
+    (getCheckpoint)(getPaths)(isSpent)(checkRoots))
@@ -1,13 +1,17 @@
 #include "platon/platon.hpp"
 #include "platon/crypto/bn256/bn256.hpp"
-#include "platon/hash/mimc.hpp"
 #include "common.hpp"
+#include "compressed_proof.hpp"
+#include "merkle_tree.hpp"
 
 using namespace platon::crypto::bn256::g16;
-using namespace platon::hash::mimc;
 
 CONTRACT PrivacyArc20 : public platon::Contract
 {
+private:
+    // first member, so a profile covers the storage write-back below
+    PRIVACY_PROFILER
+
 public:
     // commitment, amount, coinIndex, owner
     PLATON_EVENT2(create, const std::uint256_t&, std::uint256_t, uint64_t, const platon::bytes&)
@@ -15,62 +19,116 @@ public:
     // nullifier
     PLATON_EVENT1(destory, const std::uint256_t&)
 
+    // compact mode: one event per action, see PackedEvent
+    PLATON_EVENT0(packed, const platon::bytes&)
+
 public:
+    // a zero arc20 address deploys a pool of the native coin: mint takes
+    // the call value and burn pays out natively, without the ARC20 calls
     ACTION void init(const platon::Address &verify, const platon::Address &arc20)
     {
-        // set owner address
-        platon::Address owner = platon::platon_caller();
-        ::platon_set_state((const platon::byte *)&kOwnerKey, sizeof(kOwnerKey),
-                           (const platon::byte *)owner.data(), owner.size);
+        SetAddress(kOwnerKey, platon::platon_caller());
+        SetAddress(kVerifyKey, verify);
+        SetAddress(kArc20Key, arc20);
+    }
+
+    // switch between create/destory events and one packed event per action
+    ACTION void setCompactEvents(bool compact)
+    {
+        CheckNoCallValue();
+        privacy_assert(platon::platon_caller() == GetAddress(kOwnerKey), "only owner can set the event mode");
+        compactEvents.self() = compact;
+    }
 
-        // set verify address
-        ::platon_set_state((const platon::byte *)&kVerifyKey, sizeof(kVerifyKey),
-                           (const platon::byte *)verify.data(), verify.size);
+    // epoch mode: the leaves of a block are hashed and their root saved
+    // once, by the first action of a later block or by commitRoot; proofs
+    // must use a finalized root, see CommitmentTree
+    ACTION void setEpochMode(bool epoch)
+    {
+        CheckNoCallValue();
+        privacy_assert(platon::platon_caller() == GetAddress(kOwnerKey), "only owner can set the epoch mode");
+        tree.SetEpochMode(epoch);
+    }
 
-        // set arc20 address
-        ::platon_set_state((const platon::byte *)&kArc20Key, sizeof(kArc20Key),
-                           (const platon::byte *)arc20.data(), arc20.size);
+    // finalize the pending leaves now instead of in the next block
+    ACTION void commitRoot()
+    {
+        CheckNoCallValue();
+        tree.Finalize();
     }
 
     // mint
     void mint(const std::vector<std::uint256_t> &inputs, const Proof &proof, const platon::bytes &owner)
     {
+        PRIVACY_PROFILE_ACTION("mint");
+
         // verify
-        platon::Address verify = GetVerify();
-        auto res = platon::platon_call_with_return_value<bool>(verify, platon::u128(0), ::platon_gas(),
-             "VerifyTx", inputs, proof, MINT);
-        privacy_assert(res.second && res.first, "mint operation zk verification failed");
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, MINT, "mint operation zk verification failed");
+        PRIVACY_PHASE("finalize");
+        tree.OnBlock(platon::platon_block_number());
+        CheckOwnerPayload(owner);
 
         // public input information
         std::uint256_t amount = inputs[0];
         std::uint256_t commitment = inputs[1];
 
         // update merkle tree
+        PRIVACY_PHASE("tree");
         commitments.self().insert(commitment);
 
-        uint64_t leafIndex = merkleWidth - 1 + zCount.self()++;
-        merkleNodes.self()[leafIndex] = commitment;
-        std::uint256_t root = updatePathToRoot(leafIndex);
-        roots.self().insert(root);
+        uint64_t leafIndex = tree.Append(commitment);
+        tree.SaveRoot();
+        PRIVACY_STATE_BYTES_ESTIMATE(32 * (CommitmentTree::kDepth + 2));
 
         // transfer
-        platon::Address arc20 = GetArc20();
-        res = platon::platon_call_with_return_value<bool>(arc20, platon::u128(0), ::platon_gas(),
-             "TransferFrom", platon::platon_caller(), platon::platon_address(), amount);
-        privacy_assert(res.second && res.first, "Failed to call the transferFrom method of the ARC20 contract across contracts");
+        PRIVACY_PHASE("arc20");
+        PayIn(GetAddress(kArc20Key), amount);
+        TRACE_ACTION("mint", "leaf:", leafIndex, "count:", tree.Count());
 
         // event
+        PRIVACY_PHASE("event");
+        if (compactEvents.self())
+        {
+            PackedEvent event(MINT, 1, 0);
+            event.AddOutput(commitment, amount, leafIndex, owner);
+            PLATON_EMIT_EVENT0(packed, event.Finish());
+            return;
+        }
         PLATON_EMIT_EVENT2(create, commitment, amount, leafIndex, owner);
     }
 
+    // mint in one transaction: consume an owner-signed ARC20 permit for the
+    // amount instead of a separate Approve, see ARC20::Permit
+    ACTION void mintWithPermit(const std::vector<std::uint256_t> &inputs, const Proof &proof,
+        const platon::bytes &owner, uint64_t deadline, const platon::bytes &signature)
+    {
+        PRIVACY_PROFILE_ACTION("mintWithPermit");
+        PRIVACY_PHASE("permit");
+        privacy_assert(!inputs.empty(), "missing mint amount");
+        platon::Address arc20 = GetAddress(kArc20Key);
+        privacy_assert(arc20 != platon::Address(0), "native coin pool has no permit");
+        auto res = platon::platon_call_with_return_value<bool>(arc20, platon::u128(0), ::platon_gas(),
+             "Permit", platon::platon_caller(), platon::platon_address(), ToU128(inputs[0]), deadline, signature);
+        privacy_assert(res.second && res.first, "Failed to call the Permit method of the ARC20 contract across contracts");
+
+        mint(inputs, proof, owner);
+    }
+
     // transfer
     void transfer(const std::vector<std::uint256_t> &inputs, const Proof &proof, const std::vector<platon::bytes> &owner)
     {
+        PRIVACY_PROFILE_ACTION("transfer");
+        CheckNoCallValue();
+
         // verify
-        platon::Address verify = GetVerify();
-        auto res = platon::platon_call_with_return_value<bool>(verify, platon::u128(0), ::platon_gas(),
-             "VerifyTx", inputs, proof, TRANSFER);
-        privacy_assert(res.second && res.first, "transfer operation zk verification failed");
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, TRANSFER, "transfer operation zk verification failed");
+        PRIVACY_PHASE("finalize");
+        tree.OnBlock(platon::platon_block_number());
+        privacy_assert(owner.size() == 2, "two owner payloads expected");
+        CheckOwnerPayload(owner[0]);
+        CheckOwnerPayload(owner[1]);
 
         // public input information
         std::uint256_t nc = inputs[0];
@@ -82,28 +140,39 @@ public:
         std::uint256_t inputRoot = inputs[6];
 
         // check
-        privacy_assert(roots.self().end() != roots.self().find(inputRoot), "invalid merkle tree root");
+        PRIVACY_PHASE("load");
+        privacy_assert(tree.KnownRoot(inputRoot), "invalid merkle tree root");
         privacy_assert(nc != nd, "Repeated input");
         privacy_assert(ze != zf, "Repeated output");
         privacy_assert(nullifiers.self().end() == nullifiers.self().find(nc), "It has been spent");
         privacy_assert(nullifiers.self().end() == nullifiers.self().find(nd), "It has been spent");
 
         // update merkle tree and nullifiers
+        PRIVACY_PHASE("tree");
         nullifiers.self().insert(nc);
         nullifiers.self().insert(nd);
         commitments.self().insert(ze);
 
-        uint64_t leafIndex = merkleWidth - 1 + zCount.self()++;
-        merkleNodes.self()[leafIndex] = ze;
-        updatePathToRoot(leafIndex);
+        tree.Append(ze);
 
         commitments.self().insert(zf);
-        leafIndex = merkleWidth - 1 + zCount.self()++;
-        merkleNodes.self()[leafIndex] = zf;
-        std::uint256_t root = updatePathToRoot(leafIndex);
-        roots.self().insert(root);
+        uint64_t leafIndex = tree.Append(zf);
+        tree.SaveRoot();
+        PRIVACY_STATE_BYTES_ESTIMATE(32 * (2 * CommitmentTree::kDepth + 5));
+        TRACE_ACTION("transfer", "leaves:", leafIndex - 1, leafIndex, "count:", tree.Count());
 
         // event
+        PRIVACY_PHASE("event");
+        if (compactEvents.self())
+        {
+            PackedEvent event(TRANSFER, 2, 2);
+            event.AddOutput(ze, zeAmount, leafIndex - 1, owner[0]);
+            event.AddOutput(zf, zfAmount, leafIndex, owner[1]);
+            event.AddNullifier(nc);
+            event.AddNullifier(nd);
+            PLATON_EMIT_EVENT0(packed, event.Finish());
+            return;
+        }
         PLATON_EMIT_EVENT2(create, ze, zeAmount, leafIndex - 1, owner[0]);
         PLATON_EMIT_EVENT2(create, zf, zfAmount, leafIndex, owner[1]);
 
@@ -115,11 +184,14 @@ public:
     void burn(const std::vector<std::uint256_t> &inputs, const Proof &proof, 
         const platon::Address &payTo)
     {
+        PRIVACY_PROFILE_ACTION("burn");
+        CheckNoCallValue();
+
         // verify
-        platon::Address verify = GetVerify();
-        auto res = platon::platon_call_with_return_value<bool>(verify, platon::u128(0), ::platon_gas(),
-             "VerifyTx", inputs, proof, BURN);
-        privacy_assert(res.second && res.first, "burn operation zk verification failed");
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, BURN, "burn operation zk verification failed");
+        PRIVACY_PHASE("finalize");
+        tree.OnBlock(platon::platon_block_number());
 
         // public input information
         std::uint256_t value = inputs[0];
@@ -127,91 +199,168 @@ public:
         std::uint256_t inputRoot = inputs[2];
 
         // check
-        privacy_assert(roots.self().end() != roots.self().find(inputRoot), "invalid merkle tree root");
+        PRIVACY_PHASE("load");
+        privacy_assert(tree.KnownRoot(inputRoot), "invalid merkle tree root");
         privacy_assert(nullifiers.self().end() == nullifiers.self().find(nc), "It has been spent");
 
         // update merkle tree and nullifiers
         nullifiers.self().insert(nc);
+        PRIVACY_STATE_BYTES_ESTIMATE(32);
 
         // transfer
-        platon::Address arc20 = GetArc20();
-        res = platon::platon_call_with_return_value<bool>(arc20, platon::u128(0), ::platon_gas(),
-             "Transfer", payTo, value);
-        privacy_assert(res.second && res.first, "Failed to call the Transfer method of the ARC20 contract across contracts");
+        PRIVACY_PHASE("arc20");
+        PayOut(GetAddress(kArc20Key), payTo, value);
+        TRACE_ACTION("burn", "payTo:", payTo.toString());
 
         // event
+        PRIVACY_PHASE("event");
+        if (compactEvents.self())
+        {
+            PackedEvent event(BURN, 0, 1);
+            event.AddNullifier(nc);
+            PLATON_EMIT_EVENT0(packed, event.Finish());
+            return;
+        }
         PLATON_EMIT_EVENT1(destory, nc);
     }
 
-private:
-    // get address of verify
-    platon::Address GetVerify()
+    // withdraw part of a note and keep the rest as a change note, inputs:
+    // amount, nullifier, root, changeAmount, changeCommitment, output
+    ACTION void burnPartial(const std::vector<std::uint256_t> &inputs, const Proof &proof,
+        const platon::Address &payTo, const platon::bytes &owner)
+    {
+        PRIVACY_PROFILE_ACTION("burnPartial");
+        CheckNoCallValue();
+
+        // verify
+        PRIVACY_PHASE("verify");
+        VerifyProof(GetAddress(kVerifyKey), inputs, proof, BURN_PARTIAL, "partial burn operation zk verification failed");
+        PRIVACY_PHASE("finalize");
+        tree.OnBlock(platon::platon_block_number());
+        privacy_assert(inputs.size() == 6, "partial burn expects 6 public inputs");
+        privacy_assert(inputs[5] == 1, "partial burn circuit output is false");
+        CheckOwnerPayload(owner);
+
+        // public input information
+        std::uint256_t value = inputs[0];
+        std::uint256_t nc = inputs[1];
+        std::uint256_t inputRoot = inputs[2];
+        std::uint256_t changeAmount = inputs[3];
+        std::uint256_t change = inputs[4];
+
+        // check, both amounts below 2^128 keep value + changeAmount from
+        // wrapping around the field in the circuit
+        PRIVACY_PHASE("load");
+        privacy_assert(tree.KnownRoot(inputRoot), "invalid merkle tree root");
+        privacy_assert(nullifiers.self().end() == nullifiers.self().find(nc), "It has been spent");
+        ToU128(value);
+        ToU128(changeAmount);
+
+        // update merkle tree and nullifiers
+        PRIVACY_PHASE("tree");
+        nullifiers.self().insert(nc);
+        commitments.self().insert(change);
+        uint64_t leafIndex = tree.Append(change);
+        tree.SaveRoot();
+        PRIVACY_STATE_BYTES_ESTIMATE(32 * (CommitmentTree::kDepth + 3));
+
+        // transfer
+        PRIVACY_PHASE("arc20");
+        PayOut(GetAddress(kArc20Key), payTo, value);
+        TRACE_ACTION("burnPartial", "payTo:", payTo.toString(), "leaf:", leafIndex);
+
+        // event
+        PRIVACY_PHASE("event");
+        if (compactEvents.self())
+        {
+            PackedEvent event(BURN_PARTIAL, 1, 1);
+            event.AddOutput(change, changeAmount, leafIndex, owner);
+            event.AddNullifier(nc);
+            PLATON_EMIT_EVENT0(packed, event.Finish());
+            return;
+        }
+        PLATON_EMIT_EVENT2(create, change, changeAmount, leafIndex, owner);
+        PLATON_EMIT_EVENT1(destory, nc);
+    }
+
+    // mint, transfer and burn with a proof whose G1 points are compressed,
+    // see CompressedProof
+    ACTION void mintCompressed(const std::vector<std::uint256_t> &inputs, const CompressedProof &proof,
+        const platon::bytes &owner)
     {
-        platon::Address addr;
-        ::platon_get_state((const platon::byte *)&kVerifyKey, sizeof(kVerifyKey),
-                           addr.data(), addr.size);
-        return addr;
+        PRIVACY_PROFILE_ACTION("mintCompressed");
+        PRIVACY_PHASE("decompress");
+        mint(inputs, DecompressProof(proof), owner);
     }
 
-    // get address of arc20
-    platon::Address GetArc20()
+    ACTION void transferCompressed(const std::vector<std::uint256_t> &inputs, const CompressedProof &proof,
+        const std::vector<platon::bytes> &owner)
     {
-        platon::Address addr;
-        ::platon_get_state((const platon::byte *)&kArc20Key, sizeof(kArc20Key),
-                           addr.data(), addr.size);
-        return addr;
+        PRIVACY_PROFILE_ACTION("transferCompressed");
+        PRIVACY_PHASE("decompress");
+        transfer(inputs, DecompressProof(proof), owner);
     }
 
-private:
-    // key
-    constexpr static uint64_t kOwnerKey = platon::name_value("owner");
-    constexpr static uint64_t kVerifyKey = platon::name_value("verify");
-    constexpr static uint64_t kArc20Key = platon::name_value("arc20");
+    ACTION void burnCompressed(const std::vector<std::uint256_t> &inputs, const CompressedProof &proof,
+        const platon::Address &payTo)
+    {
+        PRIVACY_PROFILE_ACTION("burnCompressed");
+        PRIVACY_PHASE("decompress");
+        burn(inputs, DecompressProof(proof), payTo);
+    }
 
-private:
-    // merkle tree
-    constexpr static uint64_t merkleWidth = 4294967296ul; //2^32
-    constexpr static uint32_t merkleDepth = 33;
+    // the StorageType members write themselves back after this, which the
+    // profile reports as the "storage" phase
+    ~PrivacyArc20()
+    {
+        PRIVACY_PHASE("storage");
+        PRIVACY_STATE_BYTES_ESTIMATE(tree.StorageBytesEstimate()
+            + 32 * (commitments.self().size() + nullifiers.self().size()));
+    }
+
+    // tree snapshot for client bootstrap, see Checkpoint
+    CONST Checkpoint getCheckpoint()
+    {
+        return tree.GetCheckpoint();
+    }
 
-    std::uint256_t updatePathToRoot(uint64_t p)
+    // merkle paths of several leaves, coinIndex as emitted by create
+    CONST MerklePaths getPaths(const std::vector<uint64_t> &coinIndexes)
     {
-        uint64_t s = 0, t = 0;
-        for (uint64_t r = merkleDepth - 1; r > 0; r--)
+        return tree.GetPaths(coinIndexes);
+    }
+
+    // 1 for every nullifier that has been spent
+    CONST std::vector<uint8_t> isSpent(const std::vector<std::uint256_t> &nullifierList)
+    {
+        std::vector<uint8_t> spent;
+        spent.reserve(nullifierList.size());
+        for (const std::uint256_t &nullifier : nullifierList)
         {
-            if (p % 2 == 0)
-            {
-                s = p - 1;
-                t = (p - 1) / 2;
-
-                const std::uint256_t &sHash = merkleNodes.self()[s];
-                const std::uint256_t &pHash = merkleNodes.self()[p];
-
-                std::vector<std::uint256_t> data {sHash, pHash};
-                merkleNodes.self()[t] = Mimc::Hash(data, 0);
-            }
-            else
-            { //p odd index in M
-                s = p + 1;
-                t = p / 2;
-
-                const std::uint256_t &pHash = merkleNodes.self()[p];
-                const std::uint256_t &sHash = merkleNodes.self()[s];
-                std::vector<std::uint256_t> data {pHash, sHash};
-
-                merkleNodes.self()[t] = Mimc::Hash(data, 0);
-            }
-            p = t;
+            spent.push_back(nullifiers.self().count(nullifier) != 0);
         }
+        return spent;
+    }
 
-        return merkleNodes.self()[0];
+    // 1 for every root in the root history
+    CONST std::vector<uint8_t> checkRoots(const std::vector<std::uint256_t> &rootList)
+    {
+        std::vector<uint8_t> known;
+        known.reserve(rootList.size());
+        for (const std::uint256_t &root : rootList)
+        {
+            known.push_back(tree.KnownRoot(root));
+        }
+        return known;
     }
 
 private:
-    platon::StorageType<"count"_n, uint64_t> zCount;                                    //remembers the number of commitments we hold
-    platon::StorageType<"merkleNodes"_n, std::map<uint64_t, std::uint256_t>> merkleNodes; //the entire Merkle Tree of nodes
-    platon::StorageType<"roots"_n, std::set<std::uint256_t>> roots;                        //holds each root we've calculated;
+    CommitmentTree tree;                                                                   //count, nodes and root history
     platon::StorageType<"commitments"_n, std::set<std::uint256_t>> commitments;            //array holding the commitments.
     platon::StorageType<"nullifiers"_n, std::set<std::uint256_t>> nullifiers;              //store nullifiers
+    platon::StorageType<"compact"_n, bool> compactEvents;                                   //emit packed events
 };
 
-PLATON_DISPATCH(PrivacyArc20, (init)(mint)(transfer)(burn))
+PLATON_DISPATCH(PrivacyArc20, (init)(setCompactEvents)(setEpochMode)(commitRoot)(mint)(mintWithPermit)
+    (transfer)(burn)(burnPartial)(mintCompressed)(transferCompressed)(burnCompressed)(getCheckpoint)(getPaths)
+    (isSpent)(checkRoots))
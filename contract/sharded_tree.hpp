@@ -0,0 +1,208 @@
+#pragma once
+
+#include <platon/platon.hpp>
+#include "platon/hash/mimc.hpp"
+#include "common.hpp"
+
+// Commitment tree split into K independent shards, K a power of two up to
+// 256 fixed at deployment. A commitment goes to the shard given by its low
+// bits; every shard is a tree like CommitmentTree (same heap indices, so
+// coinIndex is the position within the shard, and unset nodes are zero)
+// with its own leaf count and nodes.
+//
+// Nothing is kept in StorageType members, which load and write back a
+// whole container per action. Every count, node, root and nullifier has
+// its own state key instead, so actions on different shards read and
+// write disjoint keys and can be executed in parallel. Root history
+// entries are keyed by the root itself, new roots never collide.
+//
+// The global root, a hash of the shard roots, is only computed on demand:
+// storing it would make every action conflict again. Proofs use the root
+// of the shard their notes are in.
+class ShardedTree {
+ public:
+  constexpr static uint64_t kWidth = 4294967296ul;  // 2^32 leaves per shard
+  constexpr static uint32_t kDepth = 33;
+  constexpr static uint32_t kMaxShards = 256;
+
+  void SetShards(uint32_t shards) {
+    privacy_assert(shards > 0 && shards <= kMaxShards && (shards & (shards - 1)) == 0,
+                   "shard count must be a power of two up to 256");
+    ::platon_set_state((const platon::byte *)&kShardsKey, sizeof(kShardsKey),
+                       (const platon::byte *)&shards, sizeof(shards));
+  }
+
+  uint32_t Shards() {
+    uint32_t shards = 0;
+    ::platon_get_state((const platon::byte *)&kShardsKey, sizeof(kShardsKey),
+                       (platon::byte *)&shards, sizeof(shards));
+    return shards;
+  }
+
+  // low bits of the commitment
+  uint32_t ShardOf(const std::uint256_t &commitment) {
+    platon::bytes be;
+    commitment.ToBigEndian(be);
+    return be.empty() ? 0 : be.back() & (Shards() - 1);
+  }
+
+  uint64_t Count(uint32_t shard) {
+    uint64_t count = 0;
+    platon::FixedHash<12> key = CountKey(shard);
+    ::platon_get_state(key.data(), key.size, (platon::byte *)&count, sizeof(count));
+    return count;
+  }
+
+  std::uint256_t Root(uint32_t shard) { return NodeAt(shard, 0); }
+
+  // hash of all shard roots, for clients checking their mirror
+  std::uint256_t GlobalRoot() {
+    uint32_t shards = Shards();
+    std::vector<std::uint256_t> roots;
+    for (uint32_t shard = 0; shard < shards; shard++) roots.push_back(Root(shard));
+    return platon::hash::mimc::Mimc::Hash(roots, 0);
+  }
+
+  bool KnownRoot(const std::uint256_t &root) {
+    platon::FixedHash<40> key = ValueKey(kRootKey, root);
+    return ::platon_get_state_length(key.data(), key.size) != 0;
+  }
+
+  // appends a leaf and updates its path, reading one sibling per level;
+  // returns the leaf's heap index within the shard
+  uint64_t Append(uint32_t shard, const std::uint256_t &commitment) {
+    uint64_t count = Count(shard);
+    privacy_assert(count < kWidth, "shard is full");
+    platon::FixedHash<12> key = CountKey(shard);
+    uint64_t next = count + 1;
+    ::platon_set_state(key.data(), key.size, (const platon::byte *)&next, sizeof(next));
+
+    uint64_t leafIndex = kWidth - 1 + count;
+    std::uint256_t node = commitment;
+    SetNode(shard, leafIndex, node);
+    for (uint64_t p = leafIndex; p > 0; p = (p - 1) / 2) {
+      // odd heap indices are left children
+      std::vector<std::uint256_t> data = p % 2 == 1
+          ? std::vector<std::uint256_t>{node, NodeAt(shard, p + 1)}
+          : std::vector<std::uint256_t>{NodeAt(shard, p - 1), node};
+      node = platon::hash::mimc::Mimc::Hash(data, 0);
+      SetNode(shard, (p - 1) / 2, node);
+    }
+    return leafIndex;
+  }
+
+  // adds the shard's current root to the root history, once per action
+  void SaveRoot(uint32_t shard) {
+    platon::FixedHash<40> key = ValueKey(kRootKey, Root(shard));
+    uint8_t known = 1;
+    ::platon_set_state(key.data(), key.size, (const platon::byte *)&known, sizeof(known));
+  }
+
+  bool Spent(const std::uint256_t &nullifier) {
+    platon::FixedHash<40> key = ValueKey(kNullifierKey, nullifier);
+    return ::platon_get_state_length(key.data(), key.size) != 0;
+  }
+
+  void Spend(const std::uint256_t &nullifier) {
+    platon::FixedHash<40> key = ValueKey(kNullifierKey, nullifier);
+    uint8_t spent = 1;
+    ::platon_set_state(key.data(), key.size, (const platon::byte *)&spent, sizeof(spent));
+  }
+
+  // snapshot of one shard for client bootstrap, see Checkpoint
+  Checkpoint GetCheckpoint(uint32_t shard) {
+    CheckShard(shard);
+    Checkpoint checkpoint;
+    checkpoint.count = Count(shard);
+    checkpoint.root = Root(shard);
+    checkpoint.frontier.resize(kDepth - 1);
+    for (uint32_t level = 0; level < kDepth - 1; level++) {
+      uint64_t position = checkpoint.count >> level;
+      if (position % 2 == 1) {
+        checkpoint.frontier[level] = NodeAt(shard, (kWidth >> level) - 1 + position - 1);
+      }
+    }
+    return checkpoint;
+  }
+
+  // merkle paths of several leaves of one shard
+  MerklePaths GetPaths(uint32_t shard, const std::vector<uint64_t> &coinIndexes) {
+    CheckShard(shard);
+    uint64_t end = kWidth - 1 + Count(shard);
+    std::set<uint64_t> siblings;
+    for (uint64_t p : coinIndexes) {
+      privacy_assert(p >= kWidth - 1 && p < end, "unknown coin index");
+      for (; p > 0; p = (p - 1) / 2) {
+        siblings.insert(p % 2 == 0 ? p - 1 : p + 1);
+      }
+    }
+
+    MerklePaths paths;
+    paths.root = Root(shard);
+    for (uint64_t index : siblings) {
+      std::uint256_t node = NodeAt(shard, index);
+      if (node != 0) {
+        paths.indexes.push_back(index);
+        paths.nodes.push_back(node);
+      }
+    }
+    return paths;
+  }
+
+  void CheckShard(uint32_t shard) { privacy_assert(shard < Shards(), "unknown shard"); }
+
+ private:
+  // Every key starts with its own 8 byte name, so keys of different kinds
+  // never clash, whatever their length. NodeKey is 20 bytes like an
+  // address, but the contract keeps nothing keyed by a bare address; its
+  // other keys are the 8 byte names of common.hpp.
+  platon::FixedHash<12> CountKey(uint32_t shard) {
+    platon::FixedHash<12> key;
+    memcpy(key.data(), &kCountKey, sizeof(kCountKey));
+    memcpy(key.data() + sizeof(kCountKey), &shard, sizeof(shard));
+    return key;
+  }
+
+  platon::FixedHash<20> NodeKey(uint32_t shard, uint64_t index) {
+    platon::FixedHash<20> key;
+    memcpy(key.data(), &kNodeKey, sizeof(kNodeKey));
+    memcpy(key.data() + sizeof(kNodeKey), &shard, sizeof(shard));
+    memcpy(key.data() + sizeof(kNodeKey) + sizeof(shard), &index, sizeof(index));
+    return key;
+  }
+
+  platon::FixedHash<40> ValueKey(uint64_t name, const std::uint256_t &value) {
+    platon::FixedHash<40> key;
+    memcpy(key.data(), &name, sizeof(name));
+    platon::bytes be;
+    value.ToBigEndian(be);
+    memcpy(key.data() + sizeof(name) + 32 - be.size(), be.data(), be.size());
+    return key;
+  }
+
+  // nodes are stored as 32 bytes big endian, an absent key reads as zero;
+  // one host call per node, Append reads one per level
+  std::uint256_t NodeAt(uint32_t shard, uint64_t index) {
+    platon::FixedHash<20> key = NodeKey(shard, index);
+    platon::byte value[32] = {0};
+    if (::platon_get_state(key.data(), key.size, value, sizeof(value)) <= 0) return 0;
+    std::uint256_t result = 0;
+    for (platon::byte b : value) result = (result << 8) | std::uint256_t(b);
+    return result;
+  }
+
+  void SetNode(uint32_t shard, uint64_t index, const std::uint256_t &node) {
+    platon::FixedHash<20> key = NodeKey(shard, index);
+    platon::bytes be;
+    node.ToBigEndian(be);
+    platon::byte value[32] = {0};
+    memcpy(value + 32 - be.size(), be.data(), be.size());
+    ::platon_set_state(key.data(), key.size, value, sizeof(value));
+  }
+
+  constexpr static uint64_t kShardsKey = platon::name_value("shards");
+  constexpr static uint64_t kCountKey = platon::name_value("scount");
+  constexpr static uint64_t kNodeKey = platon::name_value("snode");
+  constexpr static uint64_t kRootKey = platon::name_value("sroot");
+  constexpr static uint64_t kNullifierKey = platon::name_value("snullifier");
+};
@@ -196,6 +196,97 @@ class Verifier {
 };
 } // namespace burn
 
+/// Verifying keys of circuits without a generated verifier in this file,
+/// set once by the owner after their trusted setup. A key is stored under
+/// its proof type as 32 byte big endian words, in the argument order of the
+/// verifiers above: alpha x, y; beta, gamma and delta as x.c1, x.c0, y.c1,
+/// y.c0; then x, y of every gamma_abc point. client/tools/verifying_key
+/// prints this list from a zokrates verification.key.
+namespace registered {
+
+constexpr uint64_t kKeyName = platon::name_value("vkey");
+
+/// Number of gamma_abc points of a registrable proof type, the public
+/// inputs of its circuit plus its output plus one; 0 for other types.
+size_t GammaAbcSize(uint8_t type) {
+  switch (type) {
+    case POOL_MINT:
+      return 5;
+    case POOL_TRANSFER:
+      return 9;
+    case POOL_BURN:
+      return 6;
+    case BURN_PARTIAL:
+      return 7;
+  }
+  return 0;
+}
+
+FixedHash<9> StateKey(uint8_t type) {
+  FixedHash<9> key;
+  memcpy(key.data(), &kKeyName, sizeof(kKeyName));
+  key.data()[sizeof(kKeyName)] = type;
+  return key;
+}
+
+bool Has(uint8_t type) {
+  FixedHash<9> key = StateKey(type);
+  return ::platon_get_state_length(key.data(), key.size) != 0;
+}
+
+void Store(uint8_t type, const std::vector<std::uint256_t> &words) {
+  bytes value(words.size() * 32, 0);
+  for (size_t i = 0; i < words.size(); i++) {
+    bytes be;
+    words[i].ToBigEndian(be);
+    memcpy(value.data() + i * 32 + 32 - be.size(), be.data(), be.size());
+  }
+  FixedHash<9> key = StateKey(type);
+  ::platon_set_state(key.data(), key.size, value.data(), value.size());
+}
+
+/// Reverts when no key has been set for the type.
+VerifyingKey Load(uint8_t type) {
+  FixedHash<9> key = StateKey(type);
+  size_t length = ::platon_get_state_length(key.data(), key.size);
+  privacy_assert(length != 0, "no verifying key for this proof type");
+  bytes value(length);
+  ::platon_get_state(key.data(), key.size, value.data(), value.size());
+
+  std::vector<std::uint256_t> w(length / 32, 0);
+  for (size_t i = 0; i < length; i++) {
+    w[i / 32] = (w[i / 32] << 8) | std::uint256_t(value[i]);
+  }
+  VerifyingKey vk{G1{w[0], w[1]}, G2(w[2], w[3], w[4], w[5]),
+                  G2(w[6], w[7], w[8], w[9]), G2(w[10], w[11], w[12], w[13]), {}};
+  for (size_t i = 14; i + 1 < w.size(); i += 2) {
+    vk.gamma_abc.push_back(G1{w[i], w[i + 1]});
+  }
+  return vk;
+}
+
+/// Same check as Verifier::Verify above, true for a valid proof.
+bool Verify(uint8_t type, const std::vector<std::uint256_t> &inputs,
+            const Proof &proof) {
+  std::uint256_t snark_scalar_field =
+      "21888242871839275222246405745257275088548364400416034343698204186575808495617"_uint256;
+  VerifyingKey vk = Load(type);
+  platon_assert(inputs.size() + 1 == vk.gamma_abc.size());
+
+  // Compute the linear combination vk_x
+  G1 vk_x = G1{0, 0};
+  for (size_t i = 0; i < inputs.size(); i++) {
+    platon_assert(inputs[i] < snark_scalar_field);
+    vk_x = Addition(vk_x, ScalarMul(vk.gamma_abc[i + 1], inputs[i]));
+  }
+  vk_x = Addition(vk_x, vk.gamma_abc[0]);
+
+  return pairing::PairingProd4(proof.a, proof.b, Neg(vk_x), vk.gamma,
+                               Neg(proof.c), vk.delta, Neg(vk.alpha), vk.beta);
+}
+
+}  // namespace registered
+
 }  // namespace g16
 }  // namespace bn256
 }  // namespace crypto
@@ -205,19 +296,39 @@ using namespace platon::crypto::bn256::g16;
 
 CONTRACT Verify : public platon::Contract{
     public:
-        ACTION void init(){}
+        ACTION void init(){
+            SetAddress(kOwnerKey, platon::platon_caller());
+        }
+
+        // verifying key of a circuit without a built-in verifier, see
+        // registered; a key can not be replaced once set
+        ACTION void setVerifyingKey(uint8_t tranferType, const std::vector<std::uint256_t> &key){
+            privacy_assert(platon::platon_caller() == GetAddress(kOwnerKey), "only owner can set a verifying key");
+            size_t points = registered::GammaAbcSize(tranferType);
+            privacy_assert(points != 0, "proof type has a built-in verifying key");
+            privacy_assert(key.size() == 14 + 2 * points, "verifying key size does not match the circuit");
+            privacy_assert(!registered::Has(tranferType), "verifying key already set");
+            registered::Store(tranferType, key);
+        }
+
+        // true for a valid proof; Verifier::Verify returns 0 for one
         CONST bool VerifyTx(const std::vector<std::uint256_t> &inputs, const Proof &proof, uint8_t tranferType){
             switch (tranferType) {
                 case MINT:
-                    return mint::Verifier::Verify(inputs, proof);
+                    return mint::Verifier::Verify(inputs, proof) == 0;
                 case TRANSFER:
-                    return transfer::Verifier::Verify(inputs, proof);
+                    return transfer::Verifier::Verify(inputs, proof) == 0;
                 case BURN:
-                    return burn::Verifier::Verify(inputs, proof);
+                    return burn::Verifier::Verify(inputs, proof) == 0;
+                case POOL_MINT:
+                case POOL_TRANSFER:
+                case POOL_BURN:
+                case BURN_PARTIAL:
+                    return registered::Verify(tranferType, inputs, proof);
             }
 
             return false;
         }
 };
 
-PLATON_DISPATCH(Verify, (init)(VerifyTx))
\ No newline at end of file
+PLATON_DISPATCH(Verify, (init)(setVerifyingKey)(VerifyTx))
\ No newline at end of file